@@ -0,0 +1,99 @@
+// 基准程序：按实例文件顺序在单线程上逐个求解，每个实例重复 --repeat 次取最短耗时，
+// 同时输出与硬件无关的计数（CT 节点、低层扩展），便于对比优化前后和做 PGO 训练
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "mapf/mapf.h"
+
+using namespace mapf;
+
+static void usage() {
+    std::cerr <<
+        "usage: mapf_bench INSTANCES [options]\n"
+        "  --repeat N         solve each instance N times, report the fastest (default 1)\n"
+        "  --time-limit MS    per-solve time limit (default 10000)\n"
+        "  --cache N          low-level result cache entries\n"
+        "  --prune-dups       drop duplicate CT nodes\n"
+        "  --incremental      incremental low level\n"
+        "  --disjoint         disjoint splitting\n"
+        "  --symmetry         rectangle/corridor reasoning\n"
+        "  --subopt W         bounded-suboptimal search\n"
+        "  --eight            8-connected motion (same as --motion eight)\n"
+        "  --motion M         four|eight|eight-cheap-wait|eight-costly-wait (8-connected wait cost 10 / 5 / 20)\n"
+        "  --robust K         k-robust planning\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) { usage(); return 2; }
+    std::string file = argv[1];
+    int repeat = 1;
+    CBSOptions opt;
+    opt.timeLimitMs = 10000;
+
+    for (int i = 2; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) { usage(); std::exit(2); }
+            return argv[++i];
+        };
+        if      (a == "--repeat")      repeat = std::max(1, std::atoi(next().c_str()));
+        else if (a == "--time-limit")  opt.timeLimitMs = std::atoi(next().c_str());
+        else if (a == "--cache")       opt.lowLevelCacheCapacity = (size_t)std::atol(next().c_str());
+        else if (a == "--prune-dups")  opt.pruneDuplicateNodes = true;
+        else if (a == "--incremental") opt.incrementalLowLevel = true;
+        else if (a == "--disjoint")    opt.disjointSplitting = true;
+        else if (a == "--symmetry")    opt.symmetryReasoning = true;
+        else if (a == "--subopt")      opt.suboptimality = std::atof(next().c_str());
+        else if (a == "--eight")       opt.motion = MotionModel::EightConnected;
+        else if (a == "--motion") {
+            if (!parseMotionModel(next(), opt.motion)) { usage(); return 2; }
+        }
+        else if (a == "--robust")      opt.robustness = std::atoi(next().c_str());
+        else { usage(); return 2; }
+    }
+
+    std::ifstream in(file);
+    if (!in) { std::cerr << "cannot open " << file << "\n"; return 1; }
+    // 实例里的相对地图路径按实例文件所在目录解析
+    size_t slash = file.find_last_of("/\\");
+    std::string dir = slash == std::string::npos ? std::string() : file.substr(0, slash + 1);
+
+    MapCache maps;
+    int solved = 0, failed = 0;
+    long long totalCt = 0, totalExp = 0;
+    double totalMs = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        Instance inst;
+        std::string err;
+        if (!parseInstance(line, inst, &err)) { std::cerr << "bad instance: " << err << "\n"; return 1; }
+        if (!inst.map.empty() && inst.map[0] != '/' && inst.map.find(':') == std::string::npos)
+            inst.map = dir + inst.map;
+        auto grid = maps.get(inst.map, &err);
+        if (!grid) { std::cerr << inst.id << ": " << err << "\n"; return 1; }
+
+        double best = 0;
+        bool ok = false;
+        CBSStats st;
+        std::vector<Path> sol;
+        for (int r = 0; r < repeat; r++) {
+            ok = CBS(*grid, inst.starts, inst.goals, sol, opt, &st);
+            best = r == 0 ? st.runtimeMs : std::min(best, st.runtimeMs);
+        }
+        int soc = !ok ? -1 : sumOfCosts(sol, opt.motion);
+        std::cout << inst.id << " " << (ok ? "ok" : st.timedOut ? "timeout" : "nosol")
+                  << " soc=" << soc << " ct=" << st.ctExpanded << " llexp=" << st.lowLevelExpansions
+                  << " ms=" << best << "\n";
+        (ok ? solved : failed)++;
+        totalCt += st.ctExpanded;
+        totalExp += st.lowLevelExpansions;
+        totalMs += best;
+    }
+    std::cout << "[bench] solved=" << solved << " failed=" << failed << " ct=" << totalCt
+              << " llexp=" << totalExp << " ms=" << totalMs << "\n";
+    return 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <iosfwd>
+#include <unordered_map>
+#include "grid.h"
+#include "cbs.h"
+
+namespace mapf {
+
+enum class OutputFormat {
+    Text,    // 每个实例一行：id 状态 key=value 统计 paths=...
+    Binary   // 定长小端记录，见 batch.cpp 里的 writeBinary
+};
+
+struct BatchOptions {
+    int threads = 0;                 // 求解线程数，0 = 硬件线程数；--serve 时所有连接共用这么多线程
+    OutputFormat format = OutputFormat::Text;
+    bool writePaths = true;
+    CBSOptions cbs;                  // 每个实例的求解选项（时间上限等）
+    // 每个实例用 portfolioCBS 并发跑 defaultPortfolio 的配置；cbs 的时间上限和
+    // suboptimality 作为整体限制，文本结果里多一个 variant= 记录胜出配置
+    bool portfolio = false;
+    // 组合求解时每个实例同时跑几个配置，0 = 硬件线程数 / threads（至少 1），
+    // 这样求解线程总数不超过硬件线程数
+    int portfolioThreads = 0;
+    // > 0 时每张地图按这个簇大小建一次分层地图（缓存在 MapCache 里），低层在走廊内搜索
+    int hierarchyClusterSize = 0;
+    // > 0 时 CBS 之后用 LNS（见 lns.h）在这么多毫秒内继续降低代价和，文本结果里多一个 lnsgain= 记录降了多少；
+    // CBS 超时没解出时 LNS 从优先级规划的解开始，解出就按 ok 输出（variant=lns，不保证最优）。
+    // 只用于 4 连通、非 k-robust 的求解
+    int lnsMs = 0;
+};
+
+struct BatchSummary {
+    int instances = 0;
+    int solved = 0;
+    int unsolved = 0;                // 无解或超时
+    int errors = 0;                  // 实例行/地图有误
+};
+
+class MapHierarchy;
+
+// 地图缓存：同一个地图文件只读一次，多个线程、多个连接共享
+struct MapCache {
+    std::shared_ptr<const Grid> get(const std::string& path, std::string* err = nullptr);
+    // 该地图的分层地图，第一次请求时建；簇大小不同的请求各建一份
+    std::shared_ptr<const MapHierarchy> hierarchy(const std::string& path, int clusterSize,
+                                                  std::string* err = nullptr);
+
+    // 读地图、建分层地图都在锁外：每个键第一个请求的线程负责建，同一个键的并发请求等这份结果，
+    // 别的键不受影响。失败的键会删掉，之后的请求重试
+    template <class T>
+    struct Loaded {
+        std::shared_ptr<const T> value;
+        std::string err;
+    };
+    template <class T>
+    using Slot = std::shared_future<Loaded<T>>;
+
+    std::mutex mu;                           // 只保护两张表本身
+    std::unordered_map<std::string, Slot<Grid>> maps;
+    std::unordered_map<std::string, Slot<MapHierarchy>> hierarchies;
+};
+
+class WorkerPool;
+
+// 从 in 读取实例流（每行一个，格式见 instance_io.h），在线程池上并发求解，
+// 结果按完成顺序写到 out，每条写完立即 flush，适合管道常驻进程。
+// solvers 为空时自建 opt.threads 个线程的池；非空时用它（多条流共用一个有上限的池）
+BatchSummary runBatch(std::istream& in, std::ostream& out,
+                      const BatchOptions& opt, MapCache& maps, WorkerPool* solvers = nullptr);
+
+// 常驻服务：在本地 Unix socket 上监听，每个连接是一条独立的实例流，
+// 共享同一个地图缓存和同一个 opt.threads 个线程的求解池，连接再多求解线程数也不变。
+// 只在 POSIX 平台可用，失败时返回 false
+bool serveBatch(const std::string& socketPath, const BatchOptions& opt,
+                std::string* err = nullptr);
+
+} // namespace mapf
@@ -1,14 +1,102 @@
 #pragma once
 #include <vector>
+#include <cstddef>
+#include <string>
+#include <atomic>
 #include "grid.h"
 #include "constraints.h"
 
 namespace mapf {
 
+class Tracer;
+class Metrics;
+class MapHierarchy;
+
+enum class MotionModel {
+    FourConnected,            // 4 连通 + 等待，单位代价（默认，所有加速选项都可用）
+    EightConnected,           // 8 连通 + 等待，直行 10 / 斜行 14 / 等待 10，见 motion_model.h
+    EightConnectedCheapWait,  // 同上，等待 5
+    EightConnectedCostlyWait  // 同上，等待 20
+};
+
+inline bool isEightConnected(MotionModel m) { return m != MotionModel::FourConnected; }
+// 命令行名字：four / eight / eight-cheap-wait / eight-costly-wait；不认识的名字返回 false
+bool parseMotionModel(const std::string& name, MotionModel& out);
+
+// 每个 CT 节点从哪个冲突分裂
+enum class ConflictSelection {
+    Earliest,      // 时间最早的冲突（默认）
+    Random,        // 所有冲突里按 seed 随机挑一个
+    MostInvolved   // 两个 agent 涉及的冲突总数最多的那个
+};
+
+struct CBSOptions {
+    MotionModel motion = MotionModel::FourConnected;   // 非 4 连通时忽略 incrementalLowLevel、symmetryReasoning
+    int timeLimitMs = 0;           // 0 表示不限时
+    int ctNodeLimit = 0;           // 扩展的 CT 节点数上限，0 表示不限；到上限按超时返回（timedOut）
+    size_t lowLevelCacheCapacity = 0;  // 低层结果 LRU 缓存条数，0 表示不缓存
+    bool pruneDuplicateNodes = false;  // 丢弃约束集合与已生成节点相同的 CT 节点
+    bool incrementalLowLevel = false;  // 子节点重规划时复用父节点该 agent 的搜索树
+    bool disjointSplitting = false;    // 正/负约束分裂，两个子节点的解空间不相交
+    bool symmetryReasoning = false;    // 矩形/走廊冲突用 barrier/range 约束一次分裂
+    ConflictSelection conflictSelection = ConflictSelection::Earliest;
+    // 有界次优：> 1 时在代价不超过 w * 下界的节点（focal）里优先扩展冲突最少的，
+    // 解的代价不超过 w * 最优
+    double suboptimality = 1.0;
+    unsigned seed = 0;                 // 非 0 时同代价 CT 节点按 seed 随机打破平局，也用于随机选冲突
+    const std::atomic<bool>* cancel = nullptr;   // 外部置 true 后尽快返回 false（协作取消）
+    // 内存受限模式：open 里完整节点（约束 + 路径）的内存上限，0 表示不限。超出后排在最后的节点
+    // 只保留相对父节点的约束增量，弹出时重规划路径；较早的增量写到 spillPath（为空则用临时文件）
+    size_t memoryBudgetBytes = 0;
+    std::string spillPath;
+    Tracer* tracer = nullptr;          // 非空时记录 CT 扩展/分裂、低层调用和缓存事件（见 trace.h）
+    Metrics* metrics = nullptr;        // 非空时把本次求解和每次低层搜索计入在线性能计数（见 metrics.h）
+    // 非空时低层只在分层地图给出的走廊内搜索（见 hierarchy.h），走廊内找不到再退回整图；
+    // 走廊限制下解不保证最优。必须是在同一个 grid 上建的，否则忽略；增量模式下也忽略
+    const MapHierarchy* hierarchy = nullptr;
+    // 热启动：非空时作为根节点的初始联合计划（可以有冲突，通常是上一周期的解）。第 i 条路径里
+    // 若出现新起点，就从它第一次出现处截取后缀；后缀合法（可通行、每步符合运动模型）且终点不变的
+    // agent 直接沿用，其余 agent 照常规划。沿用的路径不一定最短，解的最优性随之不再保证
+    const std::vector<Path>* initialPaths = nullptr;
+    // k-robust：> 0 时任意两个 agent 占用同一格子的时刻至少相隔 k+1 步，容忍最多 k 步的延迟。
+    // 冲突用覆盖 k+1 个时刻的区间约束一次分裂；此时忽略 disjointSplitting，symmetryReasoning 只做矩形推理
+    int robustness = 0;
+};
+
+struct CBSStats {
+    int ctExpanded = 0;            // 弹出并检测冲突的 CT 节点数
+    int ctGenerated = 0;           // 生成（入队）的 CT 节点数
+    int lowLevelCalls = 0;         // spaceTimeAStar 调用次数
+    long long lowLevelExpansions = 0;
+    long long cacheHits = 0;
+    long long cacheMisses = 0;
+    long long cacheEvictions = 0;
+    int duplicatesPruned = 0;
+    int symmetrySplits = 0;        // 按矩形/走廊冲突分裂的次数
+    int nodesSpilled = 0;          // 内存受限模式下降级为冷节点的次数
+    int nodesRestored = 0;         // 弹出时从约束增量重建的冷节点数
+    int corridorFallbacks = 0;     // 走廊内找不到路径、退回整图搜索的次数
+    int warmStartReused = 0;       // 根节点直接沿用初始计划的 agent 数
+    double runtimeMs = 0;
+    bool timedOut = false;
+    bool cancelled = false;
+};
+
 // 返回是否找到无冲突解；solution 里是每个 agent 的完整路径
 bool CBS(const Grid& grid,
          const std::vector<Pos>& starts,
          const std::vector<Pos>& goals,
          std::vector<Path>& solution);
 
+// 同上，可设置求解选项并取回统计（stats 可为空）
+bool CBS(const Grid& grid,
+         const std::vector<Pos>& starts,
+         const std::vector<Pos>& goals,
+         std::vector<Path>& solution,
+         const CBSOptions& opt,
+         CBSStats* stats = nullptr);
+
+// 按运动模型计的代价和（sumOfCosts<Model> 的运行时分派）
+int sumOfCosts(const std::vector<Path>& paths, MotionModel motion);
+
 } // namespace mapf
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include "grid.h"
+#include "motion_model.h"
 
 namespace mapf {
 
@@ -13,13 +14,33 @@ struct Conflict {
     int x = -1, y = -1;
     // edge（以 a 的移动为准）
     int ax1=0, ay1=0, ax2=0, ay2=0;
+    // b 同一时刻的移动：对穿时是 a 的反向，8 连通斜向交叉时是另一条对角线
+    int bx1=0, by1=0, bx2=0, by2=0;
+    // k-robust 顶点冲突：a 在 t 时刻、b 在 t + delay 时刻（0 <= delay <= k）占用 (x,y)
+    int delay = 0;
 };
 
 Pos posAt(const Path& p, int t);
 Conflict detectFirstConflict(const std::vector<Path>& paths);
+// 每对 agent 最早的一个冲突，按时间排序
+std::vector<Conflict> detectAllConflicts(const std::vector<Path>& paths);
+
+// 按运动模型实例化的版本（上面两个等价于 Model = FourConnected），
+// 8 连通时还会检测同一个 2x2 方格里两条对角线交叉的冲突。
+// k > 0 时按 k-robust 检测：两个 agent 占用同一格子的时刻相差不超过 k 就算冲突（对穿已包含在内），
+// 按后一次占用的时刻排序；用“格子 -> 最近 k 步内的占用者”表扫描，代价随 k 线性增长
+template <class Model>
+Conflict detectFirstConflict(const std::vector<Path>& paths, int k = 0);
+template <class Model>
+std::vector<Conflict> detectAllConflicts(const std::vector<Path>& paths, int k = 0);
 
 // 工具
-int sumOfCosts(const std::vector<Path>& paths);
+int pathCost(const Path& p);   // 不计到达终点后的原地等待
+int sumOfCosts(const std::vector<Path>& paths);   // 各 pathCost 之和；CBS 按它排序 open 表
+template <class Model>
+typename Model::Cost pathCost(const Path& p);
+template <class Model>
+typename Model::Cost sumOfCosts(const std::vector<Path>& paths);
 int makespan(const std::vector<Path>& paths);
 void padPathsToSameLength(std::vector<Path>& paths);
 
@@ -1,12 +1,20 @@
 #pragma once
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
+#include <utility>
 #include <algorithm>
 #include "grid.h"
 
 namespace mapf {
 
-enum class ConstraintType { Vertex, Edge };
+enum class ConstraintType {
+    Vertex, Edge,
+    PositiveVertex,   // 本 agent 必须在 t 时刻位于 (x1,y1)；对其他 agent 等价于顶点约束
+    PositiveEdge,     // 本 agent 必须在 t 时刻走 (x1,y1)->(x2,y2)；对其他 agent 等价于两个顶点 + 反向边
+    Range,            // 禁止在 [t, t2] 内任意时刻位于 (x1,y1)
+    Barrier           // 从 (x1,y1) 到 (x2,y2) 的直线段，第 i 个格子禁止在 t+i 时刻占用
+};
 
 struct Constraint {
     int agent = -1;
@@ -14,11 +22,29 @@ struct Constraint {
     int t = 0;
     int x1 = 0, y1 = 0;   // Vertex: forbid (x1,y1) at time t
     int x2 = 0, y2 = 0;   // Edge  : forbid (x1,y1)->(x2,y2) at time t
+    int t2 = 0;           // Range : 结束时刻（含）
 };
 
+inline bool isPositive(ConstraintType type) {
+    return type == ConstraintType::PositiveVertex || type == ConstraintType::PositiveEdge;
+}
+
+// 约束最后生效的时刻
+inline int constraintEndTime(const Constraint& c) {
+    switch (c.type) {
+        case ConstraintType::PositiveEdge: return c.t + 1;
+        case ConstraintType::Range:        return c.t2;
+        case ConstraintType::Barrier:      return c.t + std::abs(c.x2 - c.x1) + std::abs(c.y2 - c.y1);
+        default:                           return c.t;
+    }
+}
+
 inline long long keyVertex(int x, int y, int t) {
     return ((long long)t << 40) ^ ((long long)x << 20) ^ (long long)y;
 }
+inline long long keyCell(int x, int y) {
+    return ((long long)x << 20) ^ (long long)y;
+}
 inline long long keyEdge(int x1, int y1, int x2, int y2, int t) {
     long long k = (long long)t;
     k = (k << 12) ^ x1; k = (k << 12) ^ y1;
@@ -29,33 +55,172 @@ inline long long keyEdge(int x1, int y1, int x2, int y2, int t) {
 struct ConstraintTable {
     std::unordered_set<long long> forbV;
     std::unordered_set<long long> forbE;
+    std::unordered_map<long long, std::vector<std::pair<int, int>>> forbRange;  // 格子 -> 禁止的时间区间
+    std::unordered_map<int, long long> mustV;                                  // 正约束：t -> 必须所在的格子
+
+    // 终点汇总（按 goal 建表时才有）：停在终点被禁止的最晚时刻、原地等待边被禁止的最晚时刻，-1 表示没有。
+    // 低层判断“到达后能否一直停在终点”时直接比较，不用逐时刻查表
+    long long goalCell = -1;
+    int goalVertexLast = -1;
+    int goalWaitLast = -1;
 };
 
 inline bool violatesVertex(const ConstraintTable& ct, int x, int y, int t) {
-    return ct.forbV.count(keyVertex(x, y, t)) > 0;
+    if (ct.forbV.count(keyVertex(x, y, t))) return true;
+    if (!ct.forbRange.empty()) {
+        auto it = ct.forbRange.find(keyCell(x, y));
+        if (it != ct.forbRange.end())
+            for (const auto& r : it->second)
+                if (r.first <= t && t <= r.second) return true;
+    }
+    if (!ct.mustV.empty()) {
+        auto it = ct.mustV.find(t);
+        if (it != ct.mustV.end() && it->second != keyCell(x, y)) return true;
+    }
+    return false;
 }
 inline bool violatesEdge(const ConstraintTable& ct, int x1, int y1, int x2, int y2, int t) {
     return ct.forbE.count(keyEdge(x1, y1, x2, y2, t)) > 0;
 }
 
+// 其他 agent 的正约束对本 agent 是负约束
+inline void addPositiveAsNegative(ConstraintTable& ct, const Constraint& c) {
+    ct.forbV.insert(keyVertex(c.x1, c.y1, c.t));
+    if (c.type == ConstraintType::PositiveEdge) {
+        ct.forbV.insert(keyVertex(c.x2, c.y2, c.t + 1));
+        ct.forbE.insert(keyEdge(c.x2, c.y2, c.x1, c.y1, c.t));
+        // 斜向移动（8 连通）：同一 2x2 方格里的另一条对角线也不能走
+        if (c.x1 != c.x2 && c.y1 != c.y2) {
+            ct.forbE.insert(keyEdge(c.x1, c.y2, c.x2, c.y1, c.t));
+            ct.forbE.insert(keyEdge(c.x2, c.y1, c.x1, c.y2, c.t));
+        }
+    }
+}
+
+inline void addConstraint(ConstraintTable& ct, const Constraint& c) {
+    switch (c.type) {
+        case ConstraintType::Vertex:
+            ct.forbV.insert(keyVertex(c.x1, c.y1, c.t));
+            break;
+        case ConstraintType::Edge:
+            ct.forbE.insert(keyEdge(c.x1, c.y1, c.x2, c.y2, c.t));
+            break;
+        case ConstraintType::PositiveVertex:
+            ct.mustV[c.t] = keyCell(c.x1, c.y1);
+            break;
+        case ConstraintType::PositiveEdge:
+            ct.mustV[c.t] = keyCell(c.x1, c.y1);
+            ct.mustV[c.t + 1] = keyCell(c.x2, c.y2);
+            break;
+        case ConstraintType::Range:
+            ct.forbRange[keyCell(c.x1, c.y1)].push_back({c.t, c.t2});
+            break;
+        case ConstraintType::Barrier: {
+            int dx = (c.x2 > c.x1) - (c.x2 < c.x1), dy = (c.y2 > c.y1) - (c.y2 < c.y1);
+            int len = std::abs(c.x2 - c.x1) + std::abs(c.y2 - c.y1);
+            for (int i = 0; i <= len; i++) ct.forbV.insert(keyVertex(c.x1 + i * dx, c.y1 + i * dy, c.t + i));
+            break;
+        }
+    }
+}
+
 inline ConstraintTable buildConstraintTable(const std::vector<Constraint>& cons, int agent) {
     ConstraintTable ct;
     for (const auto& c : cons) {
-        if (c.agent != agent) continue;
-        if (c.type == ConstraintType::Vertex) ct.forbV.insert(keyVertex(c.x1, c.y1, c.t));
-        else ct.forbE.insert(keyEdge(c.x1, c.y1, c.x2, c.y2, c.t));
+        if (c.agent == agent) addConstraint(ct, c);
+        else if (isPositive(c.type)) addPositiveAsNegative(ct, c);
+    }
+    return ct;
+}
+
+// CT 节点上的约束索引：每个 agent 自己的约束、所有正约束在 constraints 里的下标，
+// 各 agent / 全体的最晚约束时刻，以及 agent 自身负约束对其终点的汇总。
+// 追加约束时 O(1) 更新，重规划建表只看相关约束，不随 CT 深度增长
+struct ConstraintIndex {
+    std::vector<std::vector<int>> own;
+    std::vector<int> positives;
+    std::vector<int> maxTime;
+    std::vector<int> goalVertexLast, goalWaitLast;
+    int maxTimeAll = 0;
+};
+
+inline void resetConstraintIndex(ConstraintIndex& idx, int agents) {
+    idx.own.assign(agents, {});
+    idx.positives.clear();
+    idx.maxTime.assign(agents, 0);
+    idx.goalVertexLast.assign(agents, -1);
+    idx.goalWaitLast.assign(agents, -1);
+    idx.maxTimeAll = 0;
+}
+
+// cons[pos] 刚追加到约束列表末尾；goals 用来更新终点汇总
+inline void indexConstraint(ConstraintIndex& idx, const std::vector<Constraint>& cons, int pos,
+                            const std::vector<Pos>& goals) {
+    const Constraint& c = cons[pos];
+    int end = constraintEndTime(c);
+    idx.maxTimeAll = std::max(idx.maxTimeAll, end);
+    if (isPositive(c.type)) idx.positives.push_back(pos);
+    if (c.agent < 0 || c.agent >= (int)idx.own.size()) return;
+    idx.own[c.agent].push_back(pos);
+    idx.maxTime[c.agent] = std::max(idx.maxTime[c.agent], end);
+
+    // 正约束在建表时由 mustV 汇总，这里只看负约束
+    const Pos& g = goals[c.agent];
+    int& v = idx.goalVertexLast[c.agent];
+    switch (c.type) {
+        case ConstraintType::Vertex:
+            if (c.x1 == g.x && c.y1 == g.y) v = std::max(v, c.t);
+            break;
+        case ConstraintType::Edge:
+            if (c.x1 == g.x && c.y1 == g.y && c.x2 == g.x && c.y2 == g.y)
+                idx.goalWaitLast[c.agent] = std::max(idx.goalWaitLast[c.agent], c.t);
+            break;
+        case ConstraintType::Range:
+            if (c.x1 == g.x && c.y1 == g.y) v = std::max(v, c.t2);
+            break;
+        case ConstraintType::Barrier: {
+            int dx = (c.x2 > c.x1) - (c.x2 < c.x1), dy = (c.y2 > c.y1) - (c.y2 < c.y1);
+            int len = std::abs(c.x2 - c.x1) + std::abs(c.y2 - c.y1);
+            for (int i = 0; i <= len; i++)
+                if (c.x1 + i * dx == g.x && c.y1 + i * dy == g.y) v = std::max(v, c.t + i);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// 只用索引建表，并填好 goal 的终点汇总；结果与 buildConstraintTable(cons, agent) 相同
+inline ConstraintTable buildConstraintTable(const std::vector<Constraint>& cons, const ConstraintIndex& idx,
+                                            int agent, const Pos& goal) {
+    ConstraintTable ct;
+    ct.goalCell = keyCell(goal.x, goal.y);
+    ct.goalVertexLast = idx.goalVertexLast[agent];
+    ct.goalWaitLast = idx.goalWaitLast[agent];
+    for (int k : idx.own[agent]) addConstraint(ct, cons[k]);
+    for (int k : idx.positives) {
+        const Constraint& c = cons[k];
+        if (c.agent == agent) continue;
+        addPositiveAsNegative(ct, c);
+        if (c.x1 == goal.x && c.y1 == goal.y) ct.goalVertexLast = std::max(ct.goalVertexLast, c.t);
+        if (c.type == ConstraintType::PositiveEdge) {
+            if (c.x2 == goal.x && c.y2 == goal.y) ct.goalVertexLast = std::max(ct.goalVertexLast, c.t + 1);
+        }
     }
+    // 本 agent 的正约束：要求在别处的时刻都不能停在终点
+    for (const auto& m : ct.mustV)
+        if (m.second != ct.goalCell) ct.goalVertexLast = std::max(ct.goalVertexLast, m.first);
     return ct;
 }
 
 inline int maxConstraintTimeForAgent(const std::vector<Constraint>& cons, int agent) {
     int mx = 0;
-    for (const auto& c : cons) if (c.agent == agent) mx = std::max(mx, c.t);
+    for (const auto& c : cons) if (c.agent == agent) mx = std::max(mx, constraintEndTime(c));
     return mx;
 }
 inline int maxConstraintTimeAll(const std::vector<Constraint>& cons) {
     int mx = 0;
-    for (const auto& c : cons) mx = std::max(mx, c.t);
+    for (const auto& c : cons) mx = std::max(mx, constraintEndTime(c));
     return mx;
 }
 inline int lowerBoundLen(const std::vector<Pos>& starts, const std::vector<Pos>& goals) {
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include "constraints.h"
+
+namespace mapf {
+
+// CT 节点的约束增量：每个节点只记父节点编号和它比父节点多的那条约束，按节点编号顺序追加。
+// 内存里只留最近的 ramRecords 条，更早的记录（多半属于早已展开的浅层节点）写到溢出文件，
+// 需要时按偏移读回。溢出文件打不开时退化为全部留在内存里
+class DeltaStore {
+public:
+    // spillPath 为空时用匿名临时文件
+    DeltaStore(size_t ramRecords, const std::string& spillPath = std::string());
+    ~DeltaStore();
+    DeltaStore(const DeltaStore&) = delete;
+    DeltaStore& operator=(const DeltaStore&) = delete;
+
+    // 节点编号必须等于 size()；根节点 parent = -1、con 为空
+    void append(int parent, const Constraint* con);
+    // 从根到 id 路径上的全部约束，按加入顺序
+    bool constraintsOf(int id, std::vector<Constraint>& out);
+
+    size_t size() const { return spilled_ + ram_.size(); }
+    size_t spilled() const { return spilled_; }
+    size_t ramBytes() const { return ram_.capacity() * sizeof(Record); }
+
+private:
+    struct Record {
+        int32_t parent;
+        int32_t type;       // -1 表示没有约束（根节点）
+        int32_t agent, t, x1, y1, x2, y2, t2;
+    };
+
+    bool read(size_t id, Record& r);
+    void spillHalf();
+
+    size_t ramRecords_;
+    std::vector<Record> ram_;     // 编号 [spilled_, size()) 的记录
+    size_t spilled_ = 0;
+    std::FILE* file_ = nullptr;
+    std::string path_;            // 非空时析构删除
+};
+
+} // namespace mapf
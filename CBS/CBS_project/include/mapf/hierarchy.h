@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <climits>
+#include <unordered_map>
+#include "grid.h"
+#include "cbs.h"
+
+namespace mapf {
+
+// 一次查询的走廊：抽象路径经过的簇（外扩 halo 圈相邻簇），以及走廊内每格到终点的精确距离
+// （按运动模型代价、不算等待）。内存只和走廊面积成正比，与地图大小无关
+class Corridor {
+public:
+    static constexpr int kUnreachable = INT_MAX;
+
+    bool empty() const { return blocks_.empty(); }
+    // 不在走廊内、或在走廊内到不了终点时返回 kUnreachable
+    int dist(int x, int y) const {
+        if (x < 0 || y < 0) return kUnreachable;
+        auto it = blocks_.find((y / C_) * ncx_ + x / C_);
+        if (it == blocks_.end()) return kUnreachable;
+        return dist_[(size_t)it->second * C_ * C_ + (size_t)(y % C_) * C_ + x % C_];
+    }
+    size_t clusters() const { return blocks_.size(); }
+    size_t bytes() const { return dist_.capacity() * sizeof(int) + blocks_.size() * 2 * sizeof(int); }
+
+private:
+    friend class MapHierarchy;
+    int* slot(int x, int y) {
+        auto it = blocks_.find((y / C_) * ncx_ + x / C_);
+        if (it == blocks_.end()) return nullptr;
+        return &dist_[(size_t)it->second * C_ * C_ + (size_t)(y % C_) * C_ + x % C_];
+    }
+
+    int C_ = 1, ncx_ = 0;
+    std::unordered_map<int, int> blocks_;   // 簇编号 -> dist_ 里的块号
+    std::vector<int> dist_;                 // 每块 C*C 格，块内按行排列
+};
+
+// HPA* 式的分层地图：网格切成 C x C 的簇，相邻簇边界上每段连续的开口取 1~2 个入口（两侧各一个抽象节点），
+// 簇内入口两两之间的 4 连通距离预先算好。每张地图建一次，建好后只读，可多线程共享；
+// 构造时记住 grid 的地址，grid 必须比它活得久
+class MapHierarchy {
+public:
+    explicit MapHierarchy(const Grid& grid, int clusterSize = 16);
+
+    // 在抽象图上找 start -> goal 经过的簇，外扩 halo 圈后算走廊内到 goal 的距离。
+    // 抽象图上不连通时返回空走廊
+    Corridor corridor(Pos start, Pos goal, MotionModel motion = MotionModel::FourConnected, int halo = 1) const;
+
+    const Grid& grid() const { return *grid_; }
+    int clusterSize() const { return C_; }
+    size_t nodes() const { return pos_.size(); }
+    size_t edges() const { return adj_.size(); }
+
+private:
+    struct Edge { int to; int cost; };
+
+    int clusterOf(Pos p) const { return (p.y / C_) * ncx_ + p.x / C_; }
+    // 簇内从 src 出发的 4 连通 BFS，d 按簇内局部坐标存步数（-1 不可达）
+    void clusterBfs(Pos src, std::vector<int>& d) const;
+    int local(Pos p) const { return (p.y % C_) * C_ + p.x % C_; }
+    int addNode(Pos p, std::unordered_map<int, int>& index);
+    void addEntrances(int x, int y, int dx, int dy, int len, std::unordered_map<int, int>& index,
+                      std::vector<std::vector<Edge>>& out);
+    bool abstractPath(Pos start, Pos goal, std::vector<int>& clusters) const;
+    template <class Model>
+    static void fillDistances(const Grid& grid, Pos goal, Corridor& cor);
+
+    const Grid* grid_;
+    int C_, ncx_, ncy_;
+    std::vector<Pos> pos_;              // 抽象节点所在格子
+    std::vector<int> clusterStart_;     // 簇 c 的节点是 clusterNodes_[clusterStart_[c], clusterStart_[c+1])
+    std::vector<int> clusterNodes_;
+    std::vector<int> adjStart_;         // 节点 u 的边是 adj_[adjStart_[u], adjStart_[u+1])
+    std::vector<Edge> adj_;
+};
+
+} // namespace mapf
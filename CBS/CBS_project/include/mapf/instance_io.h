@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <iosfwd>
+#include "grid.h"
+
+namespace mapf {
+
+// 一个求解实例：地图文件 + 每个 agent 的起点/终点
+struct Instance {
+    std::string id;
+    std::string map;
+    std::vector<Pos> starts;
+    std::vector<Pos> goals;
+};
+
+// 读地图：支持 MovingAI .map（type/height/width/map 头，'@' 'O' 'T' 'W' 为障碍），
+// 也支持只有 '.'/'#' 行的纯文本地图。障碍统一转成 '#'
+bool loadGrid(const std::string& path, Grid& grid, std::string* err = nullptr);
+bool readGrid(std::istream& in, Grid& grid, std::string* err = nullptr);
+
+// 实例行格式：<id> <map> <n> sx sy gx gy ...（共 n 组），'#' 开头为注释
+bool parseInstance(const std::string& line, Instance& inst, std::string* err = nullptr);
+
+// 路径的紧凑编码："x,y:" 后跟每步的动作 R/L/D/U/W，末尾的等待不写
+std::string encodePath(const Path& p);
+bool decodePath(const std::string& s, Path& p);
+
+} // namespace mapf
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include "grid.h"
+
+namespace mapf {
+
+// 邻域选择方式（MAPF-LNS）
+enum class NeighborhoodKind {
+    Random,      // 随机挑 agent
+    AgentBased,  // 延迟最大的 agent + 挡在它路上的 agent
+    MapBased,    // 经过某个路口附近的 agent
+    Adaptive     // 按历史改进量自适应地在上面三种之间轮盘选择
+};
+
+struct LNSOptions {
+    int timeLimitMs = 1000;      // 调度窗口内可用的总时间
+    int maxIterations = 0;       // 0 表示只受时间限制
+    int neighborhoodSize = 8;    // 每轮破坏并重规划的 agent 数
+    int numThreads = 0;          // 每轮并行评估的候选邻域个数，0 = 硬件线程数
+    unsigned seed = 0;
+    NeighborhoodKind kind = NeighborhoodKind::Adaptive;
+};
+
+struct LNSStats {
+    int iterations = 0;          // 评估过的候选邻域总数
+    int improvements = 0;
+    int initialCost = 0;
+    int finalCost = 0;
+};
+
+// 每找到更优解就回调一次（在调用 LNS 的线程里执行），paths 已补齐到相同长度
+using LNSCallback = std::function<void(const std::vector<Path>& paths, int cost)>;
+
+// 任意时间改进：solution 传入可行初始解（例如 CBS 的结果），为空时先用优先级规划构造；
+// 返回 false 表示连初始解都没有。结束时 solution 为找到的最好解
+bool LNS(const Grid& grid,
+         const std::vector<Pos>& starts,
+         const std::vector<Pos>& goals,
+         std::vector<Path>& solution,
+         const LNSOptions& opt = LNSOptions{},
+         const LNSCallback& onImprove = LNSCallback{},
+         LNSStats* stats = nullptr);
+
+} // namespace mapf
@@ -1,11 +1,45 @@
 #pragma once
 #include <vector>
+#include <memory>
 #include "grid.h"
 #include "constraints.h"
+#include "motion_model.h"
 
 namespace mapf {
 
 // 带约束的 Space-Time A*（并做 goal-safe 到 maxT，返回路径会补齐到 maxT+1）
-Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct);
+// expansions 非空时累加本次扩展的状态数
+Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                    long long* expansions = nullptr);
+
+// 按运动模型实例化的版本，上面的等价于 Model = FourConnected。maxT 仍按时间步计
+template <class Model>
+Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                    long long* expansions = nullptr);
+
+class Corridor;
+
+// 只在走廊内搜索（见 hierarchy.h），启发式用走廊内的精确距离，内存和扩展数随路径长度而不是地图面积增长。
+// 走廊外的绕行找不到：返回空路径时调用方应退回整图搜索。corridor 为空时等价于上面的版本
+template <class Model>
+Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                    const Corridor& corridor, long long* expansions = nullptr);
+
+// 增量模式用的时空搜索树（只支持 4 连通单位代价）：已生成的状态、到达它的动作、是否已扩展（紧凑的开放寻址表）。
+// 单位代价下 g == t，所以不需要保存 g
+struct SearchTree;
+
+// 从头搜索，同时把搜索树保存到 tree
+Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                    std::shared_ptr<SearchTree>& tree, long long* expansions = nullptr);
+
+// 增量重规划（LPA* 式复用）：parent 是同一 agent 上一次的搜索树，ct 比当时的约束多了 added
+// （added 为空表示约束没变、只是 maxT 变了）。只删掉被新约束切断的子树、重新挂接还能到达的状态，
+// 再用剩下的 open 继续搜索。parent 不会被修改，新的搜索树写到 tree
+Path spaceTimeAStarIncremental(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                               const Constraint* added,
+                               const std::shared_ptr<const SearchTree>& parent,
+                               std::shared_ptr<SearchTree>& tree,
+                               long long* expansions = nullptr);
 
 } // namespace mapf
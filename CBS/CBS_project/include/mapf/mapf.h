@@ -0,0 +1,23 @@
+#pragma once
+
+// libmapf 的对外头文件：链接库的程序只需包含这一个。
+// 求解入口是 CBS()（选项见 CBSOptions），其余是批处理、组合求解、校验、分层地图、实例读写和性能计数
+
+#define MAPF_VERSION_MAJOR 0
+#define MAPF_VERSION_MINOR 1
+#define MAPF_VERSION_PATCH 0
+
+#include "grid.h"
+#include "constraints.h"
+#include "motion_model.h"
+#include "cbs.h"
+#include "conflict.h"
+#include "low_level_astar.h"
+#include "portfolio.h"
+#include "lns.h"
+#include "validator.h"
+#include "hierarchy.h"
+#include "instance_io.h"
+#include "batch.h"
+#include "trace.h"
+#include "metrics.h"
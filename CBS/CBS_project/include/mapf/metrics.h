@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <iosfwd>
+
+#include "mapf/thread_slots.h"
+
+namespace mapf {
+
+struct CBSStats;
+
+// 常驻进程的在线性能计数：CBS() 每次求解结束、低层每次搜索往里记一笔（经 CBSOptions::metrics）。
+// 每个写线程第一次记录时分到自己的分片，之后只做原子 relaxed 读写，不加锁；
+// 写线程退出时它的分片并入汇总后释放，分片数只等于还在写的线程数。
+// 导出时把汇总和现有分片加起来，输出 Prometheus 文本格式（0.0.4）。导出不需要写线程停下，
+// 但各个指标不是同一时刻的快照
+class Metrics {
+public:
+    Metrics();
+    ~Metrics();
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // 一次 CBS() 结束：结果、耗时、CT 节点、低层扩展、缓存命中率等
+    void recordSolve(const CBSStats& st, bool solved);
+    // 一次低层搜索（缓存命中不算）：扩展数和耗时
+    void recordLowLevel(long long expansions, double seconds);
+
+    std::string prometheusText() const;
+    void writePrometheus(std::ostream& out) const;
+    // 写到 path：先写 path.tmp 再改名，textfile 采集器不会读到半个文件
+    bool dumpToFile(const std::string& path, std::string* err = nullptr) const;
+
+    // 现有分片数（还在写的线程数），诊断用
+    size_t shardCount() const;
+
+private:
+    struct Shard;
+    Shard* localShard();
+    void sum(std::vector<uint64_t>& counts, std::vector<double>& sums) const;
+
+    mutable std::mutex mu_;                  // 保护 shards_ 的注册、注销和汇总
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<uint64_t> retiredCounts_;    // 已退出线程的分片并进来的值
+    std::vector<double> retiredSums_;
+    ThreadSlots slots_;                      // 最后一个成员：最先析构，之后退出的线程不再归还分片
+};
+
+// 在本地 Unix socket 上提供快照：每个连接收到一份 prometheusText() 后关闭。
+// 客户端先发 HTTP 请求（Prometheus、curl --unix-socket）时带 HTTP 响应头，否则只写正文。
+// 阻塞到 stop 被置 true（每 200ms 检查一次）或出错；只在 POSIX 平台可用，失败时返回 false
+bool serveMetrics(const Metrics& metrics, const std::string& socketPath,
+                  const std::atomic<bool>* stop = nullptr, std::string* err = nullptr);
+
+} // namespace mapf
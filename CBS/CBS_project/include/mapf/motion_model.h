@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdlib>
+#include <algorithm>
+#include "grid.h"
+
+namespace mapf {
+
+// 运动模型策略：动作表、代价类型和启发式都是编译期常量，低层搜索和冲突检测按模型实例化，
+// 4 连通单位代价的热路径里没有运行时分派。
+// 约定：kMoves 个动作，最后一个是原地等待；dx/dy/cost 按动作下标排列；
+// heuristic 必须可采纳；stepCost 给出相邻两个时刻位置之间的代价。
+// 新模型需要在 low_level_astar.cpp、conflict.cpp 末尾加显式实例化，并在 cbs.h 的 MotionModel 和 CBS() 里分派
+
+// 4 连通 + 等待，所有动作代价 1（g == t）
+struct FourConnected {
+    using Cost = int;
+    static constexpr int kMoves = 5;
+    static constexpr int dx[kMoves] = {1, -1, 0, 0, 0};
+    static constexpr int dy[kMoves] = {0, 0, 1, -1, 0};
+    static constexpr Cost cost[kMoves] = {1, 1, 1, 1, 1};
+    static constexpr bool kUnitCost = true;
+    static constexpr bool kDiagonal = false;
+
+    static bool canMove(const Grid& grid, int x, int y, int k) {
+        return grid.passable(x + dx[k], y + dy[k]);
+    }
+    static Cost heuristic(const Pos& a, const Pos& b) { return manhattan(a, b); }
+    static Cost stepCost(const Pos&, const Pos&) { return 1; }
+};
+
+// 8 连通 + 等待，整数代价：直行 10，斜行 14，等待 WaitCost。斜行不能切角（两侧格子都要可通行）
+template <int WaitCost>
+struct EightConnectedT {
+    using Cost = int;
+    static constexpr int kMoves = 9;
+    static constexpr int dx[kMoves] = {1, -1, 0, 0, 1, 1, -1, -1, 0};
+    static constexpr int dy[kMoves] = {0, 0, 1, -1, 1, -1, 1, -1, 0};
+    static constexpr Cost cost[kMoves] = {10, 10, 10, 10, 14, 14, 14, 14, WaitCost};
+    static constexpr bool kUnitCost = false;
+    static constexpr bool kDiagonal = true;
+
+    static bool canMove(const Grid& grid, int x, int y, int k) {
+        if (!grid.passable(x + dx[k], y + dy[k])) return false;
+        return dx[k] == 0 || dy[k] == 0 || (grid.passable(x + dx[k], y) && grid.passable(x, y + dy[k]));
+    }
+    static Cost heuristic(const Pos& a, const Pos& b) {
+        int ax = std::abs(a.x - b.x), ay = std::abs(a.y - b.y);
+        return 10 * std::max(ax, ay) + 4 * std::min(ax, ay);
+    }
+    static Cost stepCost(const Pos& a, const Pos& b) {
+        if (a == b) return WaitCost;
+        return (a.x != b.x && a.y != b.y) ? 14 : 10;
+    }
+};
+
+using EightConnected = EightConnectedT<10>;            // 等待和直行一样贵
+using EightConnectedCheapWait = EightConnectedT<5>;    // 等待半价：让路时宁可原地等也不斜着绕
+using EightConnectedCostlyWait = EightConnectedT<20>;  // 等待一步抵两步直行：宁可绕路也不停
+
+} // namespace mapf
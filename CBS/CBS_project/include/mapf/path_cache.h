@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <list>
+#include <cstdint>
+#include <unordered_map>
+#include "grid.h"
+#include "constraints.h"
+
+namespace mapf {
+
+// 低层查询的规范化键：agent + 影响它的约束（排序去重）+ 搜索上界 maxT。
+// 不同分裂顺序得到的同一组约束会得到同一个键
+struct LowLevelKey {
+    int agent = -1;
+    int maxT = 0;
+    std::vector<Constraint> cons;
+    uint64_t hash = 0;
+
+    bool operator==(const LowLevelKey& o) const;
+};
+
+struct LowLevelKeyHash {
+    size_t operator()(const LowLevelKey& k) const noexcept { return (size_t)k.hash; }
+};
+
+LowLevelKey makeLowLevelKey(const std::vector<Constraint>& cons, int agent, int maxT);
+// 同上，只取索引里和 agent 相关的约束
+LowLevelKey makeLowLevelKey(const std::vector<Constraint>& cons, const ConstraintIndex& idx, int agent, int maxT);
+
+// 整个 CT 节点约束集合的规范化指纹（两个独立 64 位哈希），用来识别重复节点
+struct NodeFingerprint {
+    uint64_t h1 = 0, h2 = 0;
+    bool operator==(const NodeFingerprint& o) const { return h1 == o.h1 && h2 == o.h2; }
+};
+struct NodeFingerprintHash {
+    size_t operator()(const NodeFingerprint& f) const noexcept { return (size_t)(f.h1 ^ (f.h2 * 0x9e3779b97f4a7c15ULL)); }
+};
+
+NodeFingerprint fingerprintConstraints(const std::vector<Constraint>& cons);
+
+struct PathCacheStats {
+    long long hits = 0;
+    long long misses = 0;
+    long long evictions = 0;
+
+    double hitRate() const { return hits + misses ? (double)hits / (double)(hits + misses) : 0.0; }
+};
+
+// 有界 LRU 缓存：键 -> 紧凑路径（起点 + 每步一个动作字节）或“无解”
+class PathCache {
+public:
+    explicit PathCache(size_t capacity) : capacity_(capacity) {}
+
+    // 命中返回 true；path 为补齐到 maxT+1 的路径，缓存的是无解时为空
+    bool lookup(const LowLevelKey& key, Path& path);
+    // path 为空表示无解
+    void insert(const LowLevelKey& key, const Path& path);
+
+    const PathCacheStats& stats() const { return stats_; }
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        bool found = false;
+        Pos start;
+        std::vector<uint8_t> moves;
+        std::list<const LowLevelKey*>::iterator lruPos;
+    };
+
+    size_t capacity_;
+    std::unordered_map<LowLevelKey, Entry, LowLevelKeyHash> entries_;
+    std::list<const LowLevelKey*> lru_;     // 最近使用的在前
+    PathCacheStats stats_;
+};
+
+} // namespace mapf
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <iosfwd>
+#include "grid.h"
+#include "cbs.h"
+
+namespace mapf {
+
+// 组合求解器里的一个配置
+struct PortfolioVariant {
+    std::string name;
+    CBSOptions cbs;      // cancel 由组合求解器接管，设了也会被覆盖
+};
+
+struct PortfolioOptions {
+    std::vector<PortfolioVariant> variants;   // 为空时用 defaultPortfolio(maxSuboptimality)
+    int maxThreads = 0;           // 同时运行的配置数上限，0 = 硬件线程数；多出的配置排队，前面的配置没解出时接着跑
+    int timeLimitMs = 0;          // 整体时间上限，0 表示不限时；配置自己没设上限时用它
+    double maxSuboptimality = 1.0;    // 只接受 suboptimality 不超过它的配置的结果
+    std::ostream* log = nullptr;  // 非空时每次求解写一行，记录哪个配置胜出
+};
+
+struct PortfolioStats {
+    int winner = -1;              // 胜出配置在 names 里的下标，-1 表示都没解出
+    std::string winnerName;
+    CBSStats winnerStats;
+    std::vector<std::string> names;       // 参与的配置（按 maxSuboptimality 过滤后）
+    std::vector<CBSStats> variantStats;   // 与 names 对应，落败的配置是被取消时的统计，排队没轮到的全为 0
+    double runtimeMs = 0;
+};
+
+// 内置组合：不同冲突选择规则、低层引擎、次优权重和随机种子，按优先级排列，
+// 只包含 suboptimality 不超过 maxSuboptimality 的配置
+std::vector<PortfolioVariant> defaultPortfolio(double maxSuboptimality = 1.0);
+
+// 最多 maxThreads 个配置并发求 CBS（调用线程加进程内常驻线程池），返回第一个通过校验的解，其余配置协作取消。
+// 全部失败（无解/超时）时返回 false
+bool portfolioCBS(const Grid& grid,
+                  const std::vector<Pos>& starts,
+                  const std::vector<Pos>& goals,
+                  std::vector<Path>& solution,
+                  const PortfolioOptions& opt = PortfolioOptions{},
+                  PortfolioStats* stats = nullptr);
+
+} // namespace mapf
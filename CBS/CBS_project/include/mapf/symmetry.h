@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include "grid.h"
+#include "constraints.h"
+#include "conflict.h"
+
+namespace mapf {
+
+// 对称冲突推理（只适用于 4 连通、单位代价）。识别成功时 out[0]、out[1] 是两个子节点各自要加的约束，
+// 任何无冲突解至少满足其中一条，且当前两条路径分别违反它们；识别失败时返回 false，回到普通分裂
+
+// 矩形冲突：两个 agent 都走最短路、朝同一象限前进、从矩形的两条不同边进入。
+// 约束是两条 barrier：各自不能按最短路时刻经过自己要穿出的那条边。
+// k-robust（k > 0）时两者到达矩形角的时刻可以相差不超过 k：矩形内任意一对最短路相交处的时刻差都是这个值
+bool rectangleConstraints(const std::vector<Pos>& starts,
+                          const std::vector<Pos>& goals,
+                          const std::vector<Path>& paths,
+                          const Conflict& conf,
+                          Constraint out[2],
+                          int k = 0);
+
+// 走廊冲突：冲突发生在度数为 2 的格子组成的走廊里，两个 agent 方向相反。
+// 约束是两条 range：先让对方走完整条走廊之前，自己不能到达出口
+bool corridorConstraints(const Grid& grid,
+                         const std::vector<Pos>& starts,
+                         const std::vector<Path>& paths,
+                         const Conflict& conf,
+                         Constraint out[2]);
+
+} // namespace mapf
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+namespace mapf {
+
+// 每个写线程在一个 owner（Tracer、Metrics）里的私有槽位。
+// 线程第一次 local() 时调 acquire 拿一个槽位，之后查线程本地表，不加锁；
+// 线程退出时对仍存活的 owner 调 release 归还（Tracer 放回空闲表，Metrics 并入汇总后释放），
+// 所以槽位数只取决于同时写的线程数，不随先后创建过的线程数增长。
+// release 在退出线程上调用，和 acquire 之间由 owner 自己的锁同步。
+// owner 析构时先析构 ThreadSlots（声明成最后一个成员），之后退出的线程不会再碰它
+class ThreadSlots {
+public:
+    ThreadSlots(std::function<void*()> acquire, std::function<void(void*)> release);
+    ~ThreadSlots();
+    ThreadSlots(const ThreadSlots&) = delete;
+    ThreadSlots& operator=(const ThreadSlots&) = delete;
+
+    void* local();
+
+private:
+    void* attach();
+
+    uint64_t id_;
+    std::function<void*()> acquire_;
+    std::function<void(void*)> release_;
+
+    friend struct ThreadSlotTable;
+};
+
+} // namespace mapf
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include "thread_slots.h"
+
+namespace mapf {
+
+enum class TraceEventType : uint8_t {
+    CTPop = 0,       // node, arg = cost, value = 约束条数
+    CTSplit = 1,     // node = 父节点, agent = conf.a, arg = 冲突时刻, value = conf.b, detail = TraceSplit
+    LowLevel = 2,    // node, agent, arg = maxT, value = 扩展数, dur；detail 位 0 = 找到路径，位 1 = 增量
+    CacheHit = 3,    // node, agent, arg = maxT
+    CacheMiss = 4,   // node, agent, arg = maxT
+    Solve = 5        // arg = 解的代价（-1 无解），value = CT 扩展数，dur；detail 0 成功 1 无解 2 超时 3 取消
+};
+
+// CTSplit 的 detail：低 2 位是冲突种类，位 2 表示不相交分裂
+enum TraceSplit : uint8_t {
+    kSplitVertex = 0,
+    kSplitEdge = 1,
+    kSplitRectangle = 2,
+    kSplitCorridor = 3,
+    kSplitDisjoint = 4
+};
+
+struct TraceEvent {
+    uint64_t ts = 0;       // 相对 Tracer 创建时刻的纳秒
+    uint32_t dur = 0;      // 纳秒，瞬时事件为 0
+    TraceEventType type = TraceEventType::CTPop;
+    uint8_t detail = 0;
+    uint16_t tid = 0;      // 写入缓冲的编号，record 时填；先后使用同一缓冲的线程编号相同
+    int32_t node = -1;
+    int32_t agent = -1;
+    int32_t arg = 0;
+    int64_t value = 0;
+};
+
+// 结构化事件记录器。每个写线程第一次 record 时分到自己的定长环形缓冲，
+// 之后写入不加锁；缓冲满了覆盖最旧的事件（飞行记录器）。线程退出时缓冲回到空闲表，
+// 留着已写的事件给之后的线程接着用，所以缓冲数只等于同时写的线程数的峰值。
+// 导出（snapshot / write*）应在写线程都停下之后调用，Tracer 要比所有写线程活得久
+class Tracer {
+public:
+    explicit Tracer(size_t capacityPerThread = 1 << 16);
+    ~Tracer();
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    uint64_t now() const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0_).count();
+    }
+
+    void record(TraceEvent ev);
+
+    // 所有缓冲里仍保留的事件，按时间排序
+    std::vector<TraceEvent> snapshot() const;
+    // 被覆盖丢掉的事件数
+    uint64_t dropped() const;
+
+    // Chrome trace 格式（chrome://tracing、Perfetto 可直接打开）
+    void writeChromeJson(std::ostream& out) const;
+    // 紧凑二进制：8 字节魔数 "MAPFTRC1"、u64 事件数，之后每个事件 36 字节小端：
+    // u64 ts, u32 dur, u8 type, u8 detail, u16 tid, i32 node, i32 agent, i32 arg, i64 value
+    void writeBinary(std::ostream& out) const;
+
+private:
+    struct Ring;
+
+    size_t capacity_;
+    std::chrono::steady_clock::time_point t0_;
+    mutable std::mutex mu_;                  // 保护 rings_ 的注册和 free_
+    std::vector<std::unique_ptr<Ring>> rings_;
+    std::vector<Ring*> free_;                // 退出线程留下的缓冲
+    ThreadSlots slots_;                      // 最后一个成员：最先析构，之后退出的线程不再归还缓冲
+};
+
+} // namespace mapf
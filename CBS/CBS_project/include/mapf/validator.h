@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "grid.h"
+#include "cbs.h"
+
+namespace mapf {
+
+enum class ViolationKind : uint8_t {
+    Vertex,      // 两个 agent 同一时刻在同一格
+    Swap,        // 两个 agent 在同一步对穿
+    Crossing,    // 8 连通下同一步在 2x2 方格里对角线交叉
+    Obstacle,    // 位于障碍或地图外
+    Jump,        // 一步走了不合法的位移（包括切角）
+    Endpoint     // 起点/终点与给定的不符，或路径为空
+};
+
+struct Violation {
+    ViolationKind kind = ViolationKind::Vertex;
+    int t = 0;           // Swap/Crossing/Jump 是这一步的起始时刻
+    int a = -1;
+    int b = -1;          // 只有两个 agent 的冲突才有
+    Pos pos;             // 冲突/违规所在的格子（边冲突为 a 的起点）
+};
+
+struct ValidationOptions {
+    int threads = 0;                  // 按时间片分给多少个线程，0 = 硬件线程数
+    MotionModel motion = MotionModel::FourConnected;
+    size_t maxSamples = 1000;         // 最多保留多少条具体违规（按时间排序），计数不受影响
+    const std::vector<Pos>* starts = nullptr;   // 非空时检查起点
+    const std::vector<Pos>* goals = nullptr;    // 非空时检查终点
+};
+
+struct ValidationReport {
+    bool valid = true;
+    long long vertex = 0;
+    long long swap = 0;
+    long long crossing = 0;
+    long long obstacle = 0;
+    long long jump = 0;
+    long long endpoint = 0;
+    std::vector<int> perAgent;        // 每个 agent 涉及的违规数
+    std::vector<int> perTimestep;     // 每个时刻的违规数
+    std::vector<Violation> samples;
+    double runtimeMs = 0;
+
+    long long total() const { return vertex + swap + crossing + obstacle + jump + endpoint; }
+};
+
+// 检查完整的联合计划：每对 agent 的所有顶点/对穿冲突、障碍和非法移动都会计数（不在第一个冲突处停），
+// 路径结束后视为停在终点。时间轴切片后多线程并行
+ValidationReport validatePlan(const Grid& grid,
+                              const std::vector<Path>& paths,
+                              const ValidationOptions& opt = ValidationOptions{});
+
+} // namespace mapf
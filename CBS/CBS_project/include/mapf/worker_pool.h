@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace mapf {
+
+// 常驻线程池：任务排队，池里的线程取走执行，线程建好后一直复用，析构时跑完已排队的任务再回收。
+// 没有空闲线程时才加线程，线程数等于同时在跑的任务数峰值；maxThreads > 0 时不超过它，多出的任务排队。
+// 组合求解、LNS 每个实例/每一轮都要一组线程，每次新建代价高，而且每个新线程都会在 Tracer / Metrics 里占一个槽位
+class WorkerPool {
+public:
+    explicit WorkerPool(int maxThreads = 0) : maxThreads_(maxThreads) {}
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // fn(0) 在调用线程上跑，fn(1..n-1) 交给池里的线程，全部跑完才返回。
+    // 有线程上限的池不要在它自己的任务里调用：任务排在正在等待的线程后面会互相等死
+    void runAll(int n, const std::function<void(int)>& fn);
+
+    // 进程内共享的池（组合求解的配置、LNS 的候选邻域），进程退出时回收
+    static WorkerPool& shared();
+
+private:
+    void loop();
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> threads_;
+    int maxThreads_;        // 0 表示不限
+    int idle_ = 0;          // 在等任务的线程数
+    bool stop_ = false;
+};
+
+} // namespace mapf
@@ -0,0 +1,414 @@
+#include "mapf/batch.h"
+#include "mapf/instance_io.h"
+#include "mapf/conflict.h"
+#include "mapf/portfolio.h"
+#include "mapf/hierarchy.h"
+#include "mapf/lns.h"
+#include "mapf/worker_pool.h"
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <thread>
+#include <condition_variable>
+#include <streambuf>
+#include <algorithm>
+#include <cstdint>
+#include <cerrno>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace mapf {
+
+namespace {
+
+// 键对应的值只建一次，建的过程不持有 mu（见 MapCache）
+template <class T, class Build>
+std::shared_ptr<const T> loadOnce(std::mutex& mu, std::unordered_map<std::string, MapCache::Slot<T>>& table,
+                                  const std::string& key, Build build, std::string* err) {
+    std::promise<MapCache::Loaded<T>> promise;
+    MapCache::Slot<T> slot;
+    bool mine = false;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = table.find(key);
+        if (it != table.end()) {
+            slot = it->second;
+        } else {
+            slot = promise.get_future().share();
+            table.emplace(key, slot);
+            mine = true;
+        }
+    }
+    if (mine) {
+        MapCache::Loaded<T> r;
+        r.value = build(r.err);
+        if (!r.value) {
+            std::lock_guard<std::mutex> lock(mu);
+            table.erase(key);
+        }
+        promise.set_value(std::move(r));
+    }
+    const MapCache::Loaded<T>& r = slot.get();
+    if (!r.value && err) *err = r.err;
+    return r.value;
+}
+
+} // namespace
+
+std::shared_ptr<const Grid> MapCache::get(const std::string& path, std::string* err) {
+    return loadOnce<Grid>(mu, maps, path, [&](std::string& e) -> std::shared_ptr<const Grid> {
+        auto grid = std::make_shared<Grid>();
+        if (!loadGrid(path, *grid, &e)) return nullptr;
+        return grid;
+    }, err);
+}
+
+std::shared_ptr<const MapHierarchy> MapCache::hierarchy(const std::string& path, int clusterSize,
+                                                        std::string* err) {
+    auto grid = get(path, err);
+    if (!grid) return nullptr;
+
+    // grid 一直留在 maps 里，比分层地图活得久
+    std::string key = path + '#' + std::to_string(clusterSize);
+    return loadOnce<MapHierarchy>(mu, hierarchies, key, [&](std::string&) {
+        return std::make_shared<const MapHierarchy>(*grid, clusterSize);
+    }, err);
+}
+
+namespace {
+
+enum class Status : uint8_t { Ok = 0, NoSolution = 1, Timeout = 2, Error = 3 };
+
+const char* statusName(Status s) {
+    switch (s) {
+        case Status::Ok:         return "ok";
+        case Status::NoSolution: return "nosol";
+        case Status::Timeout:    return "timeout";
+        default:                 return "error";
+    }
+}
+
+struct Result {
+    std::string id;
+    Status status = Status::Error;
+    std::string error;
+    int soc = 0;
+    int makespan = 0;
+    CBSStats stats;
+    std::string variant;             // 组合模式下胜出的配置，LNS 兜底时为 lns
+    int lnsGain = -1;                // LNS 降低的代价和，-1 表示没跑 LNS
+    std::vector<Path> paths;
+};
+
+int batchThreads(const BatchOptions& opt) {
+    return opt.threads > 0 ? opt.threads : std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+Result solveLine(const std::string& line, const BatchOptions& opt, MapCache& maps) {
+    Result r;
+    Instance inst;
+    if (!parseInstance(line, inst, &r.error)) {
+        std::istringstream ls(line);
+        ls >> r.id;
+        return r;
+    }
+    r.id = inst.id;
+
+    auto grid = maps.get(inst.map, &r.error);
+    if (!grid) return r;
+    for (size_t i = 0; i < inst.starts.size(); i++) {
+        if (!grid->passable(inst.starts[i].x, inst.starts[i].y) ||
+            !grid->passable(inst.goals[i].x, inst.goals[i].y)) {
+            r.error = "agent " + std::to_string(i) + " start/goal blocked";
+            return r;
+        }
+    }
+
+    std::shared_ptr<const MapHierarchy> hier;
+    CBSOptions cbs = opt.cbs;
+    if (opt.hierarchyClusterSize > 0) {
+        hier = maps.hierarchy(inst.map, opt.hierarchyClusterSize, &r.error);
+        cbs.hierarchy = hier.get();
+    }
+
+    bool ok;
+    if (opt.portfolio) {
+        PortfolioOptions po;
+        po.timeLimitMs = cbs.timeLimitMs;
+        po.maxSuboptimality = cbs.suboptimality;
+        // 批处理已经按实例占满 threads 个线程，每个实例只分到剩下的份额
+        po.maxThreads = opt.portfolioThreads > 0
+                            ? opt.portfolioThreads
+                            : std::max(1, (int)std::thread::hardware_concurrency() / batchThreads(opt));
+        po.variants = defaultPortfolio(po.maxSuboptimality);
+        for (auto& v : po.variants) {
+            v.cbs.tracer = cbs.tracer;
+            v.cbs.metrics = cbs.metrics;
+            v.cbs.hierarchy = cbs.hierarchy;
+            v.cbs.robustness = cbs.robustness;
+        }
+        PortfolioStats ps;
+        ok = portfolioCBS(*grid, inst.starts, inst.goals, r.paths, po, &ps);
+        r.stats = ok ? ps.winnerStats : CBSStats{};
+        r.stats.runtimeMs = ps.runtimeMs;
+        for (const auto& vs : ps.variantStats) r.stats.timedOut = r.stats.timedOut || (!ok && vs.timedOut);
+        r.variant = ps.winnerName;
+    } else {
+        ok = CBS(*grid, inst.starts, inst.goals, r.paths, cbs, &r.stats);
+    }
+    bool lns = opt.lnsMs > 0 && cbs.robustness == 0 && !isEightConnected(cbs.motion);
+    if (lns && (ok || r.stats.timedOut)) {
+        if (!ok) r.paths.clear();
+        LNSOptions lo;
+        lo.timeLimitMs = opt.lnsMs;
+        lo.numThreads = 1;           // 批处理已经按实例并行
+        lo.seed = cbs.seed;
+        LNSStats ls;
+        if (LNS(*grid, inst.starts, inst.goals, r.paths, lo, LNSCallback{}, &ls)) {
+            if (!ok) r.variant = "lns";
+            r.lnsGain = ls.initialCost - ls.finalCost;
+            ok = true;
+        }
+    }
+    if (!ok) {
+        r.status = r.stats.timedOut ? Status::Timeout : Status::NoSolution;
+        r.paths.clear();
+        return r;
+    }
+    r.status = Status::Ok;
+    r.soc = sumOfCosts(r.paths);
+    for (const auto& p : r.paths) r.makespan = std::max(r.makespan, pathCost(p));
+    return r;
+}
+
+void writeText(std::ostream& out, const Result& r, bool withPaths) {
+    out << r.id << ' ' << statusName(r.status);
+    if (r.status == Status::Error) {
+        out << " msg=\"" << r.error << "\"\n";
+        return;
+    }
+    out << " soc=" << r.soc
+        << " makespan=" << r.makespan
+        << " expanded=" << r.stats.ctExpanded
+        << " generated=" << r.stats.ctGenerated
+        << " llcalls=" << r.stats.lowLevelCalls
+        << " llexp=" << r.stats.lowLevelExpansions
+        << " cachehits=" << r.stats.cacheHits
+        << " cachemiss=" << r.stats.cacheMisses
+        << " ms=" << r.stats.runtimeMs;
+    if (!r.variant.empty()) out << " variant=" << r.variant;
+    if (r.lnsGain >= 0) out << " lnsgain=" << r.lnsGain;
+    if (withPaths && r.status == Status::Ok) {
+        out << " paths=";
+        for (size_t i = 0; i < r.paths.size(); i++) {
+            if (i) out << ';';
+            out << encodePath(r.paths[i]);
+        }
+    }
+    out << '\n';
+}
+
+// 小端序写入，便于跨平台读
+template <class T>
+void put(std::string& buf, T v) {
+    auto u = static_cast<typename std::make_unsigned<T>::type>(v);
+    for (size_t i = 0; i < sizeof(T); i++) buf.push_back(char((u >> (8 * i)) & 0xff));
+}
+
+// 二进制记录：
+//   u16 id 长度, id 字节, u8 状态,
+//   i32 soc, makespan, ctExpanded, ctGenerated, lowLevelCalls, i64 lowLevelExpansions,
+//   u32 微秒（超过约 71 分钟饱和在 0xffffffff）,
+//   u32 agent 数; 每个 agent: i32 x, i32 y, u32 步数, 动作每字节两个（低 4 位在前，0=W 1=R 2=L 3=D 4=U）
+// 状态为 error 时 agent 数为 0
+void writeBinary(std::ostream& out, const Result& r, bool withPaths) {
+    std::string buf;
+    put<uint16_t>(buf, (uint16_t)r.id.size());
+    buf += r.id;
+    put<uint8_t>(buf, (uint8_t)r.status);
+    put<int32_t>(buf, r.soc);
+    put<int32_t>(buf, r.makespan);
+    put<int32_t>(buf, r.stats.ctExpanded);
+    put<int32_t>(buf, r.stats.ctGenerated);
+    put<int32_t>(buf, r.stats.lowLevelCalls);
+    put<int64_t>(buf, r.stats.lowLevelExpansions);
+    put<uint32_t>(buf, (uint32_t)std::min(r.stats.runtimeMs * 1000.0, (double)UINT32_MAX));
+
+    uint32_t n = withPaths ? (uint32_t)r.paths.size() : 0;
+    put<uint32_t>(buf, n);
+    for (uint32_t i = 0; i < n; i++) {
+        const Path& p = r.paths[i];
+        int len = pathCost(p);
+        put<int32_t>(buf, p[0].x);
+        put<int32_t>(buf, p[0].y);
+        put<uint32_t>(buf, (uint32_t)len);
+        uint8_t packed = 0;
+        for (int t = 1; t <= len; t++) {
+            int dx = p[t].x - p[t - 1].x, dy = p[t].y - p[t - 1].y;
+            uint8_t code = dx == 1 ? 1 : dx == -1 ? 2 : dy == 1 ? 3 : dy == -1 ? 4 : 0;
+            if (t % 2 == 1) packed = code;
+            else            put<uint8_t>(buf, uint8_t(packed | (code << 4)));
+        }
+        if (len % 2 == 1) put<uint8_t>(buf, packed);
+    }
+    out.write(buf.data(), (std::streamsize)buf.size());
+}
+
+bool isBlankOrComment(const std::string& line) {
+    auto p = line.find_first_not_of(" \t\r");
+    return p == std::string::npos || line[p] == '#';
+}
+
+#ifndef _WIN32
+// 把 socket fd 包成 iostream 用的 streambuf
+class FdStreamBuf : public std::streambuf {
+public:
+    explicit FdStreamBuf(int fd) : fd_(fd) {
+        setg(in_, in_, in_);
+        setp(out_, out_ + sizeof(out_));
+    }
+    ~FdStreamBuf() override { sync(); }
+
+protected:
+    int_type underflow() override {
+        ssize_t k = ::recv(fd_, in_, sizeof(in_), 0);
+        if (k <= 0) return traits_type::eof();
+        setg(in_, in_, in_ + k);
+        return traits_type::to_int_type(in_[0]);
+    }
+    int_type overflow(int_type c) override {
+        if (flushOut() < 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) sputc(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+    int sync() override { return flushOut(); }
+
+private:
+    int flushOut() {
+        char* p = pbase();
+        while (p < pptr()) {
+#ifdef MSG_NOSIGNAL
+            ssize_t k = ::send(fd_, p, pptr() - p, MSG_NOSIGNAL);
+#else
+            ssize_t k = ::send(fd_, p, pptr() - p, 0);
+#endif
+            if (k <= 0) return -1;
+            p += k;
+        }
+        setp(out_, out_ + sizeof(out_));
+        return 0;
+    }
+
+    int fd_;
+    char in_[1 << 16];
+    char out_[1 << 16];
+};
+#endif
+
+} // namespace
+
+BatchSummary runBatch(std::istream& in, std::ostream& out,
+                      const BatchOptions& opt, MapCache& maps, WorkerPool* solvers) {
+    int threads = batchThreads(opt);
+    std::unique_ptr<WorkerPool> own;
+    if (!solvers) {
+        own.reset(new WorkerPool(threads));
+        solvers = own.get();
+    }
+    const int maxInFlight = threads * 4;   // 限制读入但未处理完的实例，保持流式
+
+    std::mutex mu;
+    std::condition_variable changed;
+    int inFlight = 0;
+
+    std::mutex outMu;
+    BatchSummary sum;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (isBlankOrComment(line)) continue;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            changed.wait(lock, [&] { return inFlight < maxInFlight; });
+            inFlight++;
+        }
+        solvers->submit([&, line]() {
+            Result r = solveLine(line, opt, maps);
+            {
+                std::lock_guard<std::mutex> lock(outMu);
+                if (opt.format == OutputFormat::Binary) writeBinary(out, r, opt.writePaths);
+                else                                    writeText(out, r, opt.writePaths);
+                out.flush();
+
+                sum.instances++;
+                if (r.status == Status::Ok)         sum.solved++;
+                else if (r.status == Status::Error) sum.errors++;
+                else                                sum.unsolved++;
+            }
+            std::lock_guard<std::mutex> lock(mu);
+            inFlight--;
+            changed.notify_all();
+        });
+    }
+    std::unique_lock<std::mutex> lock(mu);
+    changed.wait(lock, [&] { return inFlight == 0; });
+    return sum;
+}
+
+bool serveBatch(const std::string& socketPath, const BatchOptions& opt, std::string* err) {
+#ifdef _WIN32
+    (void)socketPath; (void)opt;
+    if (err) *err = "socket mode is not supported on this platform, use stdin/stdout";
+    return false;
+#else
+    auto fail = [&](const std::string& what) {
+        if (err) *err = what + ": " + std::strerror(errno);
+        return false;
+    };
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        if (err) *err = "socket path too long";
+        return false;
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int lfd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0) return fail("socket");
+    ::unlink(socketPath.c_str());
+    if (::bind(lfd, (sockaddr*)&addr, sizeof(addr)) < 0) { ::close(lfd); return fail("bind"); }
+    if (::listen(lfd, 16) < 0) { ::close(lfd); return fail("listen"); }
+
+    // 所有连接共享地图缓存（进程常驻时地图只读一次）和求解池：连接只占一个读写线程，
+    // 求解线程总数固定为 opt.threads
+    auto maps = std::make_shared<MapCache>();
+    auto solvers = std::make_shared<WorkerPool>(batchThreads(opt));
+    while (true) {
+        int cfd = ::accept(lfd, nullptr, nullptr);
+        if (cfd < 0) {
+            if (errno == EINTR) continue;
+            ::close(lfd);
+            return fail("accept");
+        }
+        std::thread([cfd, opt, maps, solvers]() {
+            {
+                FdStreamBuf buf(cfd);
+                std::istream in(&buf);
+                std::ostream out(&buf);
+                runBatch(in, out, opt, *maps, solvers.get());
+            }
+            ::close(cfd);
+        }).detach();
+    }
+#endif
+}
+
+} // namespace mapf
@@ -1,9 +1,24 @@
 #include "mapf/cbs.h"
 #include "mapf/low_level_astar.h"
 #include "mapf/conflict.h"
+#include "mapf/path_cache.h"
+#include "mapf/symmetry.h"
+#include "mapf/trace.h"
+#include "mapf/metrics.h"
+#include "mapf/ct_store.h"
+#include "mapf/hierarchy.h"
 
-#include <queue>
+#include <set>
+#include <tuple>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <type_traits>
 #include <iostream>
 #include <algorithm>
 
@@ -11,39 +26,223 @@ namespace mapf {
 
 struct CTNode {
     std::vector<Constraint> constraints;
+    ConstraintIndex index;      // constraints 的按 agent 索引，追加约束时同步更新
     std::vector<Path> paths;
+    std::vector<std::shared_ptr<const SearchTree>> trees;   // 增量模式下每个 agent 最近一次的搜索树
     int cost = 0;
+    int conflicts = 0;     // 冲突对数，只在有界次优模式下计算
     int id = 0;
 };
 
-struct CTNodeCmp {
-    bool operator()(const CTNode& a, const CTNode& b) const {
-        if (a.cost != b.cost) return a.cost > b.cost;
-        return a.id > b.id;
+// 节点占用内存的估计：约束及其索引、路径和搜索树指针（搜索树本身与其他节点共享，不计）
+static size_t nodeBytes(const CTNode& nd) {
+    const ConstraintIndex& ix = nd.index;
+    size_t b = sizeof(CTNode) + nd.constraints.capacity() * sizeof(Constraint) +
+               nd.trees.capacity() * sizeof(nd.trees[0]) +
+               (ix.positives.capacity() + ix.maxTime.capacity() + ix.goalVertexLast.capacity() +
+                ix.goalWaitLast.capacity()) * sizeof(int);
+    for (const auto& v : ix.own) b += sizeof(v) + v.capacity() * sizeof(int);
+    for (const auto& p : nd.paths) b += sizeof(Path) + p.capacity() * sizeof(Pos);
+    return b;
+}
+
+static uint64_t mixTie(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static void traceEvent(Tracer* tr, TraceEventType type, int node, int agent, int arg,
+                       long long value, uint8_t detail = 0, uint64_t ts = 0, uint64_t dur = 0) {
+    TraceEvent e;
+    e.ts = ts ? ts : tr->now();
+    e.dur = (uint32_t)std::min<uint64_t>(dur, UINT32_MAX);
+    e.type = type;
+    e.detail = detail;
+    e.node = node;
+    e.agent = agent;
+    e.arg = arg;
+    e.value = value;
+    tr->record(e);
+}
+
+// all 按时间排序且非空
+static Conflict chooseConflict(const std::vector<Conflict>& all, int n,
+                               ConflictSelection rule, std::mt19937& rng) {
+    if (rule == ConflictSelection::Random)
+        return all[std::uniform_int_distribution<size_t>(0, all.size() - 1)(rng)];
+    if (rule == ConflictSelection::MostInvolved) {
+        std::vector<int> deg(n, 0);
+        for (const auto& c : all) { deg[c.a]++; deg[c.b]++; }
+        size_t best = 0;
+        for (size_t i = 1; i < all.size(); i++)
+            if (deg[all[i].a] + deg[all[i].b] > deg[all[best].a] + deg[all[best].b]) best = i;
+        return all[best];
     }
-};
+    return all.front();
+}
 
 bool CBS(const Grid& grid,
          const std::vector<Pos>& starts,
          const std::vector<Pos>& goals,
          std::vector<Path>& solution) {
+    return CBS(grid, starts, goals, solution, CBSOptions{});
+}
+
+// 热启动用的路径：p 里从 start 第一次出现处起的后缀，以 goal 结尾且每步都是 Model 的合法动作时才写到 out
+template <class Model>
+static bool warmPath(const Grid& grid, const Path& p, Pos start, Pos goal, Path& out) {
+    auto it = std::find(p.begin(), p.end(), start);
+    if (it == p.end() || !(p.back() == goal)) return false;
+    for (auto q = it; q != p.end(); ++q) {
+        if (!grid.passable(q->x, q->y)) return false;
+        if (q == it) continue;
+        int dx = q->x - (q - 1)->x, dy = q->y - (q - 1)->y;
+        bool ok = false;
+        for (int k = 0; k < Model::kMoves && !ok; k++)
+            ok = Model::dx[k] == dx && Model::dy[k] == dy && Model::canMove(grid, (q - 1)->x, (q - 1)->y, k);
+        if (!ok) return false;
+    }
+    out.assign(it, p.end());
+    return true;
+}
+
+// 路径（结束后停在终点）在 [0, horizon] 内是否满足约束表
+static bool pathSatisfies(const Path& p, const ConstraintTable& ct, int horizon) {
+    int last = (int)p.size() - 1;
+    int T = std::max(last, horizon);
+    for (int t = 0; t <= T; t++) {
+        const Pos& a = p[std::min(t, last)];
+        if (violatesVertex(ct, a.x, a.y, t)) return false;
+        const Pos& b = p[std::min(t + 1, last)];
+        if (t < T && violatesEdge(ct, a.x, a.y, b.x, b.y, t)) return false;
+    }
+    return true;
+}
+
+// CBS 主体按运动模型实例化；增量低层和对称推理只有 4 连通单位代价版本
+template <class Model>
+static bool solveCBS(const Grid& grid,
+                     const std::vector<Pos>& starts,
+                     const std::vector<Pos>& goals,
+                     std::vector<Path>& solution,
+                     const CBSOptions& opt,
+                     CBSStats* stats) {
+    constexpr bool kFour = std::is_same<Model, FourConnected>::value;
+    const bool useIncremental = kFour && opt.incrementalLowLevel;
+    const int robust = std::max(0, opt.robustness);
+    const bool useSymmetry = kFour && opt.symmetryReasoning;
+    const bool useDisjoint = opt.disjointSplitting && robust == 0;
+    const MapHierarchy* hier = opt.hierarchy && &opt.hierarchy->grid() == &grid && !useIncremental
+                             ? opt.hierarchy : nullptr;
+
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    CBSStats st;
+    Tracer* tr = opt.tracer;
+    uint64_t traceStart = tr ? tr->now() : 0;
+    std::unique_ptr<PathCache> cache;
+    if (opt.lowLevelCacheCapacity > 0) cache.reset(new PathCache(opt.lowLevelCacheCapacity));
+
+    auto finish = [&](bool ok) {
+        if (cache) {
+            st.cacheHits      = cache->stats().hits;
+            st.cacheMisses    = cache->stats().misses;
+            st.cacheEvictions = cache->stats().evictions;
+        }
+        st.runtimeMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        if (opt.metrics) opt.metrics->recordSolve(st, ok);
+        if (tr) {
+            uint8_t status = ok ? 0 : st.timedOut ? 2 : st.cancelled ? 3 : 1;
+            traceEvent(tr, TraceEventType::Solve, -1, -1, ok ? sumOfCosts<Model>(solution) : -1,
+                       st.ctExpanded, status, traceStart, tr->now() - traceStart);
+        }
+        if (stats) *stats = st;
+        return ok;
+    };
 
     int n = (int)starts.size();
     int nodeId = 0;
+    bool bounded = opt.suboptimality > 1.0;
+    bool needAll = opt.conflictSelection != ConflictSelection::Earliest;
+    std::mt19937 rng(opt.seed);
 
-    auto replanAgent = [&](CTNode& node, int agent) -> bool {
-        ConstraintTable ct = buildConstraintTable(node.constraints, agent);
+    // 每个 agent 的走廊只取决于起终点，求解开始时算一次。分层图的连通性和原图一致，
+    // 走廊为空说明起终点不连通，直接无解
+    std::vector<Corridor> corridors;
+    const int maxStepCost = *std::max_element(Model::cost, Model::cost + Model::kMoves);
+    if (hier) {
+        corridors.reserve(n);
+        for (int i = 0; i < n; i++) {
+            corridors.push_back(hier->corridor(starts[i], goals[i], opt.motion));
+            if (corridors.back().empty()) return finish(false);
+        }
+    }
+
+    // added：子节点相对父节点给该 agent 新加的约束（增量模式用），根节点为空
+    auto replanAgent = [&](CTNode& node, int agent, const Constraint* added) -> bool {
+        ConstraintTable ct;
+        bool ctBuilt = false;
 
         int lb    = lowerBoundLen(starts, goals);
         int curMS = (!node.paths.empty() ? makespan(node.paths) : 0);
-        int mxA   = maxConstraintTimeForAgent(node.constraints, agent);
-        int mxAll = maxConstraintTimeAll(node.constraints);
+        int mxA   = node.index.maxTime[agent];
+        int mxAll = node.index.maxTimeAll;
 
         int maxT = std::max({lb, curMS, mxA, mxAll}) + 10;
+        const Corridor* cor = hier && !corridors[agent].empty() ? &corridors[agent] : nullptr;
+        // 走廊距离是真实距离（按代价），除以最贵一步的代价就是步数下界，比曼哈顿下界紧得多
+        if (cor) maxT = std::max(maxT, cor->dist(starts[agent].x, starts[agent].y) / maxStepCost + 10);
 
         // 迭代加深：防止 maxT 估计偏小误判无解
         for (int attempt = 0; attempt < 3; attempt++) {
-            Path p = spaceTimeAStar(grid, starts[agent], goals[agent], maxT, ct);
+            Path p;
+            LowLevelKey key;
+            bool hit = false;
+            if (cache) {
+                key = makeLowLevelKey(node.constraints, node.index, agent, maxT);
+                hit = cache->lookup(key, p);
+                if (tr) traceEvent(tr, hit ? TraceEventType::CacheHit : TraceEventType::CacheMiss,
+                                   node.id, agent, maxT, 0);
+            }
+            if (!hit) {
+                if (!ctBuilt) { ct = buildConstraintTable(node.constraints, node.index, agent, goals[agent]); ctBuilt = true; }
+                st.lowLevelCalls++;
+                uint64_t llStart = tr ? tr->now() : 0;
+                auto llClock = opt.metrics ? Clock::now() : Clock::time_point{};
+                long long expBefore = st.lowLevelExpansions;
+                bool incremental = useIncremental && node.trees[agent] && added &&
+                                   (added->type == ConstraintType::Vertex || added->type == ConstraintType::Edge ||
+                                    added->type == ConstraintType::Range);
+                if (useIncremental) {
+                    std::shared_ptr<SearchTree> tree;
+                    p = spaceTimeAStarIncremental(grid, starts[agent], goals[agent], maxT, ct,
+                                                  added, node.trees[agent], tree, &st.lowLevelExpansions);
+                    node.trees[agent] = std::move(tree);
+                    added = nullptr;   // 之后的加深只是 maxT 变大，接着这棵树搜
+                } else if (cor) {
+                    p = spaceTimeAStar<Model>(grid, starts[agent], goals[agent], maxT, ct, *cor, &st.lowLevelExpansions);
+                    // 走廊内三次加深都失败（约束把走廊堵死或需要绕远），最后一次在整图上搜
+                    if (p.empty() && attempt == 2) {
+                        st.corridorFallbacks++;
+                        p = spaceTimeAStar<Model>(grid, starts[agent], goals[agent], maxT, ct, &st.lowLevelExpansions);
+                    }
+                } else {
+                    p = spaceTimeAStar<Model>(grid, starts[agent], goals[agent], maxT, ct, &st.lowLevelExpansions);
+                }
+                if (opt.metrics)
+                    opt.metrics->recordLowLevel(st.lowLevelExpansions - expBefore,
+                                                std::chrono::duration<double>(Clock::now() - llClock).count());
+                if (tr) {
+                    uint8_t flags = uint8_t((p.empty() ? 0 : 1) | (incremental ? 2 : 0));
+                    traceEvent(tr, TraceEventType::LowLevel, node.id, agent, maxT,
+                               st.lowLevelExpansions - expBefore, flags, llStart, tr->now() - llStart);
+                }
+                if (cache) cache->insert(key, p);
+            } else if (useIncremental) {
+                node.trees[agent].reset();   // 缓存命中没有搜索树，下次从头搜
+            }
             if (!p.empty()) {
                 node.paths[agent] = std::move(p);
                 return true;
@@ -53,62 +252,306 @@ bool CBS(const Grid& grid,
         return false;
     };
 
+    // 内存受限模式：每个节点的约束增量记在 deltas 里；open 里完整节点的内存超出预算时，
+    // 排在最后的降级为冷节点，只留排序键，弹出时由约束增量重建约束并重规划全部路径。
+    // 冷节点的代价键与重建结果不一致时按新代价重新入队，保持最优性
+    const bool memBounded = opt.memoryBudgetBytes > 0;
+    std::unique_ptr<DeltaStore> deltas;
+    if (memBounded)
+        deltas.reset(new DeltaStore(opt.memoryBudgetBytes / 8 / sizeof(Constraint), opt.spillPath));
+
     CTNode root;
     root.id = nodeId++;
+    resetConstraintIndex(root.index, n);
     root.paths.resize(n);
+    if (useIncremental) root.trees.resize(n);
+    if (deltas) deltas->append(-1, nullptr);
 
+    // 热启动沿用的路径；冷节点重建时，仍满足该节点约束的 agent 也直接沿用
+    std::vector<Path> warm(opt.initialPaths ? n : 0);
     for (int i = 0; i < n; i++) {
-        if (!replanAgent(root, i)) return false;
+        if (opt.initialPaths && i < (int)opt.initialPaths->size() && !(*opt.initialPaths)[i].empty() &&
+            warmPath<Model>(grid, (*opt.initialPaths)[i], starts[i], goals[i], warm[i])) {
+            root.paths[i] = warm[i];
+            st.warmStartReused++;
+            continue;
+        }
+        if (!replanAgent(root, i, nullptr)) return finish(false);
     }
     padPathsToSameLength(root.paths);
-    root.cost = sumOfCosts(root.paths);
+    root.cost = sumOfCosts<Model>(root.paths);
+    if (bounded) root.conflicts = (int)detectAllConflicts<Model>(root.paths, robust).size();
+
+    // 已生成节点的约束集合指纹，用于剪掉经不同分裂顺序得到的重复节点
+    std::unordered_set<NodeFingerprint, NodeFingerprintHash> seen;
+    if (opt.pruneDuplicateNodes) seen.insert(fingerprintConstraints(root.constraints));
+
+    // open 按 (cost, tie, id) 排序；focal 是 cost 不超过 bound = w * 最小 cost 的节点，
+    // 按 (冲突数, cost, tie, id) 排序。w == 1 时冲突数不参与排序，focal 的队首就是 open 的队首
+    using OpenKey  = std::tuple<int, uint64_t, int>;
+    using FocalKey = std::tuple<int, int, uint64_t, int>;
+    std::unordered_map<int, CTNode> nodes;      // open 里的完整（热）节点
+    std::unordered_map<int, int> cold;          // 冷节点 id -> 冲突数
+    std::set<OpenKey> open;
+    std::set<OpenKey> hotKeys;                  // 热节点的 open 键，降级从最后一个开始
+    std::set<FocalKey> focal;
+    size_t hotBytes = 0;
+
+    auto tieOf = [&](int id) -> uint64_t {
+        return opt.seed ? mixTie(((uint64_t)opt.seed << 32) | (uint32_t)id) : (uint64_t)id;
+    };
+    auto focalKey = [&](int conflicts, int cost, int id) {
+        return FocalKey{bounded ? conflicts : 0, cost, tieOf(id), id};
+    };
+    auto boundOf = [&](int minCost) {
+        return std::max(minCost, (int)std::floor(opt.suboptimality * minCost + 1e-9));
+    };
+    int bound = boundOf(root.cost);
+
+    auto push = [&](CTNode&& nd) {
+        OpenKey key{nd.cost, tieOf(nd.id), nd.id};
+        open.insert(key);
+        if (nd.cost <= bound) focal.insert(focalKey(nd.conflicts, nd.cost, nd.id));
+        if (memBounded) {
+            hotKeys.insert(key);
+            hotBytes += nodeBytes(nd);
+        }
+        int id = nd.id;
+        nodes.emplace(id, std::move(nd));
 
-    std::priority_queue<CTNode, std::vector<CTNode>, CTNodeCmp> open;
-    open.push(root);
+        // 超出预算：从最不可能很快展开的热节点开始降级，降到预算的 3/4，留出余量避免反复触发
+        if (memBounded && hotBytes > opt.memoryBudgetBytes) {
+            while (hotBytes > opt.memoryBudgetBytes / 4 * 3 && hotKeys.size() > 1) {
+                auto last = std::prev(hotKeys.end());
+                auto nit = nodes.find(std::get<2>(*last));
+                hotBytes -= nodeBytes(nit->second);
+                cold.emplace(nit->first, nit->second.conflicts);
+                nodes.erase(nit);
+                hotKeys.erase(last);
+                st.nodesSpilled++;
+            }
+        }
+    };
+    push(std::move(root));
+    st.ctGenerated++;
 
     while (!open.empty()) {
-        CTNode cur = open.top(); open.pop();
+        if ((opt.timeLimitMs > 0 && Clock::now() - t0 > std::chrono::milliseconds(opt.timeLimitMs)) ||
+            (opt.ctNodeLimit > 0 && st.ctExpanded >= opt.ctNodeLimit)) {
+            st.timedOut = true;
+            return finish(false);
+        }
+        if (opt.cancel && opt.cancel->load(std::memory_order_relaxed)) {
+            st.cancelled = true;
+            return finish(false);
+        }
+
+        // 最小代价变大后 bound 跟着变大，把新落进范围的节点补进 focal
+        int nb = boundOf(std::get<0>(*open.begin()));
+        if (nb > bound) {
+            for (auto it = open.upper_bound(OpenKey{bound, UINT64_MAX, INT32_MAX});
+                 it != open.end() && std::get<0>(*it) <= nb; ++it) {
+                int id = std::get<2>(*it);
+                auto hit = nodes.find(id);
+                focal.insert(focalKey(hit != nodes.end() ? hit->second.conflicts : cold.at(id),
+                                      std::get<0>(*it), id));
+            }
+            bound = nb;
+        }
+
+        int curId = std::get<3>(*focal.begin());
+        int curCost = std::get<1>(*focal.begin());
+        focal.erase(focal.begin());
+        open.erase(OpenKey{curCost, tieOf(curId), curId});
+
+        CTNode cur;
+        auto nit = nodes.find(curId);
+        if (nit != nodes.end()) {
+            cur = std::move(nit->second);
+            nodes.erase(nit);
+            if (memBounded) {
+                hotKeys.erase(OpenKey{curCost, tieOf(curId), curId});
+                hotBytes -= nodeBytes(cur);
+            }
+        } else {
+            // 冷节点：重建约束，所有 agent 从头规划
+            cold.erase(curId);
+            st.nodesRestored++;
+            cur.id = curId;
+            if (!deltas->constraintsOf(curId, cur.constraints)) return finish(false);
+            resetConstraintIndex(cur.index, n);
+            for (int k = 0; k < (int)cur.constraints.size(); k++) indexConstraint(cur.index, cur.constraints, k, goals);
+            cur.paths.resize(n);
+            if (useIncremental) cur.trees.resize(n);
+            bool ok = true;
+            int horizon = cur.index.maxTimeAll;
+            for (int i = 0; i < n && ok; i++) {
+                if (!warm.empty() && !warm[i].empty() &&
+                    pathSatisfies(warm[i], buildConstraintTable(cur.constraints, cur.index, i, goals[i]), horizon)) {
+                    cur.paths[i] = warm[i];
+                    continue;
+                }
+                ok = replanAgent(cur, i, nullptr);
+            }
+            if (!ok) continue;
+            padPathsToSameLength(cur.paths);
+            cur.cost = sumOfCosts<Model>(cur.paths);
+            if (bounded) cur.conflicts = (int)detectAllConflicts<Model>(cur.paths, robust).size();
+            if (cur.cost != curCost) {
+                push(std::move(cur));
+                continue;
+            }
+        }
+        st.ctExpanded++;
+        if (tr) traceEvent(tr, TraceEventType::CTPop, curId, -1, cur.cost, (long long)cur.constraints.size());
 
-        Conflict conf = detectFirstConflict(cur.paths);
+        Conflict conf;
+        if (needAll) {
+            std::vector<Conflict> all = detectAllConflicts<Model>(cur.paths, robust);
+            if (!all.empty()) conf = chooseConflict(all, n, opt.conflictSelection, rng);
+        } else {
+            conf = detectFirstConflict<Model>(cur.paths, robust);
+        }
         if (!conf.exists) {
             solution = cur.paths;
-            return true;
+            return finish(true);
         }
 
+        // 两个子节点各自要加的约束
+        Constraint split[2];
+        bool symmetric = false;
+        uint8_t splitKind = conf.isEdge ? kSplitEdge : kSplitVertex;
+        if (useSymmetry) {
+            if (rectangleConstraints(starts, goals, cur.paths, conf, split, robust)) {
+                symmetric = true;
+                splitKind = kSplitRectangle;
+            } else if (robust == 0 && corridorConstraints(grid, starts, cur.paths, conf, split)) {
+                symmetric = true;
+                splitKind = kSplitCorridor;
+            }
+            if (symmetric) st.symmetrySplits++;
+        }
+        if (!symmetric) {
+            for (int k = 0; k < 2; k++) {
+                int agent = (k == 0 ? conf.a : conf.b);
+                if (!conf.isEdge && robust > 0) {
+                    // k-robust：两次占用都落在 [t, t+k] 里，任何合法解里至少有一个 agent 不在这段时间占用该格子
+                    split[k] = Constraint{agent, ConstraintType::Range, conf.t, conf.x, conf.y, 0, 0, conf.t + robust};
+                } else if (!conf.isEdge) {
+                    split[k] = Constraint{agent, ConstraintType::Vertex, conf.t, conf.x, conf.y, 0, 0};
+                } else if (agent == conf.a) {
+                    split[k] = Constraint{agent, ConstraintType::Edge, conf.t,
+                                          conf.ax1, conf.ay1, conf.ax2, conf.ay2};
+                } else {
+                    split[k] = Constraint{agent, ConstraintType::Edge, conf.t,
+                                          conf.bx1, conf.by1, conf.bx2, conf.by2};
+                }
+            }
+            // 不相交分裂：两个子节点都约束 conf.a，一个强制走冲突处（正约束），一个禁止（负约束）
+            if (useDisjoint) {
+                split[1] = split[0];
+                split[0].type = conf.isEdge ? ConstraintType::PositiveEdge : ConstraintType::PositiveVertex;
+                splitKind |= kSplitDisjoint;
+            }
+        }
+        if (tr) traceEvent(tr, TraceEventType::CTSplit, curId, conf.a, conf.t, conf.b, splitKind);
+
         for (int k = 0; k < 2; k++) {
-            int agent = (k == 0 ? conf.a : conf.b);
+            const Constraint& con = split[k];
 
             CTNode child = cur;
             child.id = nodeId++;
+            child.constraints.push_back(con);
+            indexConstraint(child.index, child.constraints, (int)child.constraints.size() - 1, goals);
+            if (deltas) deltas->append(cur.id, &con);
+
+            if (opt.pruneDuplicateNodes &&
+                !seen.insert(fingerprintConstraints(child.constraints)).second) {
+                st.duplicatesPruned++;
+                continue;
+            }
 
-            // 添加约束（CBS 分裂）
-            if (!conf.isEdge) {
-                child.constraints.push_back(Constraint{
-                    agent, ConstraintType::Vertex, conf.t,
-                    conf.x, conf.y, 0, 0
-                });
+            bool ok = true;
+            if (!isPositive(con.type)) {
+                ok = replanAgent(child, con.agent, &child.constraints.back());
             } else {
-                if (agent == conf.a) {
-                    child.constraints.push_back(Constraint{
-                        agent, ConstraintType::Edge, conf.t,
-                        conf.ax1, conf.ay1, conf.ax2, conf.ay2
-                    });
-                } else {
-                    child.constraints.push_back(Constraint{
-                        agent, ConstraintType::Edge, conf.t,
-                        conf.ax2, conf.ay2, conf.ax1, conf.ay1
-                    });
+                // 正约束：本 agent 的路径本来就满足；其他 agent 多了隐含的负约束，违反的都要重规划
+                Constraint implied{-1, ConstraintType::Vertex, con.t, con.x1, con.y1, 0, 0};
+                for (int j = 0; j < n && ok; j++) {
+                    if (j == con.agent) continue;
+                    const Path& pj = child.paths[j];
+                    bool hit = posAt(pj, con.t) == Pos{con.x1, con.y1};
+                    if (con.type == ConstraintType::PositiveEdge) {
+                        hit = hit || posAt(pj, con.t + 1) == Pos{con.x2, con.y2} ||
+                              (posAt(pj, con.t) == Pos{con.x2, con.y2} &&
+                               posAt(pj, con.t + 1) == Pos{con.x1, con.y1});
+                        // 斜向正约束还隐含禁止交叉的另一条对角线（见 addPositiveAsNegative）
+                        if (Model::kDiagonal && con.x1 != con.x2 && con.y1 != con.y2) {
+                            Pos u = posAt(pj, con.t), v = posAt(pj, con.t + 1);
+                            hit = hit || (u == Pos{con.x1, con.y2} && v == Pos{con.x2, con.y1}) ||
+                                         (u == Pos{con.x2, con.y1} && v == Pos{con.x1, con.y2});
+                        }
+                    }
+                    if (!hit) {
+                        if (useIncremental) child.trees[j].reset();   // 约束变了，旧树不再可用
+                        continue;
+                    }
+                    if (con.type == ConstraintType::PositiveVertex) {
+                        implied.agent = j;
+                        ok = replanAgent(child, j, &implied);
+                    } else {
+                        if (useIncremental) child.trees[j].reset();
+                        ok = replanAgent(child, j, nullptr);
+                    }
                 }
+                if (useIncremental) child.trees[con.agent].reset();
             }
-
-            if (!replanAgent(child, agent)) continue;
+            if (!ok) continue;
 
             padPathsToSameLength(child.paths);
-            child.cost = sumOfCosts(child.paths);
-            open.push(std::move(child));
+            child.cost = sumOfCosts<Model>(child.paths);
+            if (bounded) child.conflicts = (int)detectAllConflicts<Model>(child.paths, robust).size();
+            push(std::move(child));
+            st.ctGenerated++;
         }
     }
-    return false;
+    return finish(false);
+}
+
+bool CBS(const Grid& grid,
+         const std::vector<Pos>& starts,
+         const std::vector<Pos>& goals,
+         std::vector<Path>& solution,
+         const CBSOptions& opt,
+         CBSStats* stats) {
+    switch (opt.motion) {
+        case MotionModel::EightConnected:
+            return solveCBS<EightConnected>(grid, starts, goals, solution, opt, stats);
+        case MotionModel::EightConnectedCheapWait:
+            return solveCBS<EightConnectedCheapWait>(grid, starts, goals, solution, opt, stats);
+        case MotionModel::EightConnectedCostlyWait:
+            return solveCBS<EightConnectedCostlyWait>(grid, starts, goals, solution, opt, stats);
+        default:
+            return solveCBS<FourConnected>(grid, starts, goals, solution, opt, stats);
+    }
+}
+
+int sumOfCosts(const std::vector<Path>& paths, MotionModel motion) {
+    switch (motion) {
+        case MotionModel::EightConnected:           return sumOfCosts<EightConnected>(paths);
+        case MotionModel::EightConnectedCheapWait:  return sumOfCosts<EightConnectedCheapWait>(paths);
+        case MotionModel::EightConnectedCostlyWait: return sumOfCosts<EightConnectedCostlyWait>(paths);
+        default:                                    return sumOfCosts<FourConnected>(paths);
+    }
+}
+
+bool parseMotionModel(const std::string& name, MotionModel& out) {
+    if      (name == "four")              out = MotionModel::FourConnected;
+    else if (name == "eight")             out = MotionModel::EightConnected;
+    else if (name == "eight-cheap-wait")  out = MotionModel::EightConnectedCheapWait;
+    else if (name == "eight-costly-wait") out = MotionModel::EightConnectedCostlyWait;
+    else return false;
+    return true;
 }
 
 } // namespace mapf
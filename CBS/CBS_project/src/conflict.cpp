@@ -1,5 +1,8 @@
 #include "mapf/conflict.h"
+#include "mapf/constraints.h"
 #include <algorithm>
+#include <unordered_map>
+#include <utility>
 
 namespace mapf {
 
@@ -9,7 +12,9 @@ Pos posAt(const Path& p, int t) {
     return p.back();
 }
 
-Conflict detectFirstConflict(const std::vector<Path>& paths) {
+// 按时间顺序枚举冲突；skip(i, j) 为真的 agent 对不检查，emit 返回 true 时停止
+template <class Model, class Skip, class Emit>
+static void scanConflicts(const std::vector<Path>& paths, Skip skip, Emit emit) {
     int n = (int)paths.size();
     int T = 0;
     for (const auto& p : paths) T = std::max(T, (int)p.size());
@@ -20,6 +25,7 @@ Conflict detectFirstConflict(const std::vector<Path>& paths) {
             Pos pi_prev = posAt(paths[i], t - 1);
 
             for (int j = i + 1; j < n; j++) {
+                if (skip(i, j)) continue;
                 Pos pj = posAt(paths[j], t);
 
                 // vertex conflict
@@ -27,30 +33,150 @@ Conflict detectFirstConflict(const std::vector<Path>& paths) {
                     Conflict c; c.exists = true;
                     c.isEdge = false; c.a = i; c.b = j;
                     c.t = t; c.x = pi.x; c.y = pi.y;
-                    return c;
+                    if (emit(c)) return;
+                    continue;
                 }
+                if (t == 0) continue;
 
-                // edge conflict (swap)
-                if (t > 0) {
-                    Pos pj_prev = posAt(paths[j], t - 1);
-                    if (pi_prev == pj && pj_prev == pi) {
-                        Conflict c; c.exists = true;
-                        c.isEdge = true; c.a = i; c.b = j;
-                        c.t = t - 1;
-                        c.ax1 = pi_prev.x; c.ay1 = pi_prev.y;
-                        c.ax2 = pi.x;      c.ay2 = pi.y;
-                        return c;
-                    }
+                // edge conflict：对穿，或 8 连通下在同一个 2x2 方格里对角线交叉
+                Pos pj_prev = posAt(paths[j], t - 1);
+                bool swap = pi_prev == pj && pj_prev == pi;
+                bool cross = false;
+                if (Model::kDiagonal && !swap && pi_prev.x != pi.x && pi_prev.y != pi.y) {
+                    Pos c1{pi_prev.x, pi.y}, c2{pi.x, pi_prev.y};
+                    cross = (pj_prev == c1 && pj == c2) || (pj_prev == c2 && pj == c1);
+                }
+                if (swap || cross) {
+                    Conflict c; c.exists = true;
+                    c.isEdge = true; c.a = i; c.b = j;
+                    c.t = t - 1;
+                    c.ax1 = pi_prev.x; c.ay1 = pi_prev.y;
+                    c.ax2 = pi.x;      c.ay2 = pi.y;
+                    c.bx1 = pj_prev.x; c.by1 = pj_prev.y;
+                    c.bx2 = pj.x;      c.by2 = pj.y;
+                    if (emit(c)) return;
                 }
             }
         }
     }
-    return Conflict{};
+}
+
+// k-robust 版本：按时间扫描，occ 记每个格子最近 k 步内的占用者 (agent, 最后占用时刻)。
+// agent i 在 t 时刻到 v 时，表里 v 上其他 agent 的记录就是冲突；对穿必然伴随相差 1 步的顶点冲突，
+// 只有 8 连通的对角线交叉要单独查（prev 记 t-1 时刻每个格子上的 agent）
+template <class Model, class Skip, class Emit>
+static void scanDelayConflicts(const std::vector<Path>& paths, int k, Skip skip, Emit emit) {
+    int n = (int)paths.size();
+    int T = 0;
+    for (const auto& p : paths) T = std::max(T, (int)p.size());
+
+    std::unordered_map<long long, std::vector<std::pair<int, int>>> occ;
+    std::unordered_map<long long, int> prev, now;
+    for (int t = 0; t < T; t++) {
+        now.clear();
+        for (int i = 0; i < n; i++) {
+            Pos pi = posAt(paths[i], t);
+            auto& list = occ[keyCell(pi.x, pi.y)];
+            int mine = -1;   // i 自己的记录在 list 里的下标
+            for (size_t e = 0; e < list.size();) {
+                int j = list[e].first, tj = list[e].second;
+                if (tj < t - k) {   // 过期记录顺手删掉
+                    list[e] = list.back();
+                    list.pop_back();
+                    continue;
+                }
+                if (j == i) { mine = (int)e++; continue; }
+                e++;
+                if (skip(std::min(i, j), std::max(i, j))) continue;
+                Conflict c; c.exists = true;
+                c.isEdge = false; c.a = j; c.b = i;
+                c.t = tj; c.delay = t - tj;
+                c.x = pi.x; c.y = pi.y;
+                if (emit(c)) return;
+            }
+            if (mine >= 0) list[mine].second = t;
+            else           list.push_back({i, t});
+            if (Model::kDiagonal) now[keyCell(pi.x, pi.y)] = i;
+
+            // 8 连通：i 斜走 u->w，另一 agent 同一步走交叉的对角线
+            Pos pu = posAt(paths[i], t - 1);
+            if (!Model::kDiagonal || t == 0 || pu.x == pi.x || pu.y == pi.y) continue;
+            auto it = prev.find(keyCell(pu.x, pi.y));
+            if (it == prev.end()) continue;
+            int j = it->second;
+            if (j == i || skip(std::min(i, j), std::max(i, j)) || !(posAt(paths[j], t) == Pos{pi.x, pu.y})) continue;
+            Conflict c; c.exists = true;
+            c.isEdge = true; c.a = i; c.b = j;
+            c.t = t - 1;
+            c.ax1 = pu.x; c.ay1 = pu.y;
+            c.ax2 = pi.x; c.ay2 = pi.y;
+            c.bx1 = pu.x; c.by1 = pi.y;
+            c.bx2 = pi.x; c.by2 = pu.y;
+            if (emit(c)) return;
+        }
+        std::swap(prev, now);
+    }
+}
+
+template <class Model>
+Conflict detectFirstConflict(const std::vector<Path>& paths, int k) {
+    Conflict first;
+    auto none = [](int, int) { return false; };
+    auto stop = [&](const Conflict& c) { first = c; return true; };
+    if (k > 0) scanDelayConflicts<Model>(paths, k, none, stop);
+    else       scanConflicts<Model>(paths, none, stop);
+    return first;
+}
+
+template <class Model>
+std::vector<Conflict> detectAllConflicts(const std::vector<Path>& paths, int k) {
+    size_t n = paths.size();
+    std::vector<Conflict> out;
+    std::vector<char> found(n * n, 0);   // 这一对是否已经记过（下标 i < j）
+    auto skip = [&](int i, int j) { return found[i * n + j] != 0; };
+    auto add = [&](const Conflict& c) {
+        found[std::min(c.a, c.b) * n + std::max(c.a, c.b)] = 1;
+        out.push_back(c);
+        return false;
+    };
+    if (k > 0) scanDelayConflicts<Model>(paths, k, skip, add);
+    else       scanConflicts<Model>(paths, skip, add);
+    return out;
+}
+
+Conflict detectFirstConflict(const std::vector<Path>& paths) {
+    return detectFirstConflict<FourConnected>(paths);
+}
+
+std::vector<Conflict> detectAllConflicts(const std::vector<Path>& paths) {
+    return detectAllConflicts<FourConnected>(paths);
+}
+
+template <class Model>
+typename Model::Cost pathCost(const Path& p) {
+    int n = (int)p.size();
+    while (n > 1 && p[n - 2] == p.back()) n--;
+    typename Model::Cost c = 0;
+    for (int t = 1; t < n; t++) c += Model::stepCost(p[t - 1], p[t]);
+    return c;
+}
+
+template <class Model>
+typename Model::Cost sumOfCosts(const std::vector<Path>& paths) {
+    typename Model::Cost s = 0;
+    for (const auto& p : paths) s += pathCost<Model>(p);
+    return s;
+}
+
+int pathCost(const Path& p) {
+    int n = (int)p.size();
+    while (n > 1 && p[n - 2] == p.back()) n--;
+    return std::max(0, n - 1);
 }
 
 int sumOfCosts(const std::vector<Path>& paths) {
     int s = 0;
-    for (const auto& p : paths) s += std::max(0, (int)p.size() - 1);
+    for (const auto& p : paths) s += pathCost(p);
     return s;
 }
 
@@ -68,4 +194,21 @@ void padPathsToSameLength(std::vector<Path>& paths) {
     }
 }
 
+template Conflict detectFirstConflict<FourConnected>(const std::vector<Path>&, int);
+template Conflict detectFirstConflict<EightConnected>(const std::vector<Path>&, int);
+template Conflict detectFirstConflict<EightConnectedCheapWait>(const std::vector<Path>&, int);
+template Conflict detectFirstConflict<EightConnectedCostlyWait>(const std::vector<Path>&, int);
+template std::vector<Conflict> detectAllConflicts<FourConnected>(const std::vector<Path>&, int);
+template std::vector<Conflict> detectAllConflicts<EightConnected>(const std::vector<Path>&, int);
+template std::vector<Conflict> detectAllConflicts<EightConnectedCheapWait>(const std::vector<Path>&, int);
+template std::vector<Conflict> detectAllConflicts<EightConnectedCostlyWait>(const std::vector<Path>&, int);
+template int pathCost<FourConnected>(const Path&);
+template int pathCost<EightConnected>(const Path&);
+template int pathCost<EightConnectedCheapWait>(const Path&);
+template int pathCost<EightConnectedCostlyWait>(const Path&);
+template int sumOfCosts<FourConnected>(const std::vector<Path>&);
+template int sumOfCosts<EightConnected>(const std::vector<Path>&);
+template int sumOfCosts<EightConnectedCheapWait>(const std::vector<Path>&);
+template int sumOfCosts<EightConnectedCostlyWait>(const std::vector<Path>&);
+
 } // namespace mapf
@@ -0,0 +1,95 @@
+// 32 位 POSIX 上让 off_t / fopen 也是 64 位（必须在所有头文件之前）
+#define _FILE_OFFSET_BITS 64
+#include "mapf/ct_store.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+namespace mapf {
+
+namespace {
+
+// 溢出文件会超过 2GB，不能用 fseek 的 long 偏移（Windows 上 long 只有 32 位）
+bool seekTo(std::FILE* f, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(f, (long long)offset, SEEK_SET) == 0;
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+} // namespace
+
+DeltaStore::DeltaStore(size_t ramRecords, const std::string& spillPath)
+    : ramRecords_(std::max<size_t>(ramRecords, 1024)) {
+    if (spillPath.empty()) {
+        file_ = std::tmpfile();
+    } else {
+        file_ = std::fopen(spillPath.c_str(), "w+b");
+        if (file_) path_ = spillPath;
+    }
+}
+
+DeltaStore::~DeltaStore() {
+    if (file_) std::fclose(file_);
+    if (!path_.empty()) std::remove(path_.c_str());
+}
+
+void DeltaStore::append(int parent, const Constraint* con) {
+    Record r{parent, -1, 0, 0, 0, 0, 0, 0, 0};
+    if (con) {
+        r.type = (int32_t)con->type;
+        r.agent = con->agent; r.t = con->t;
+        r.x1 = con->x1; r.y1 = con->y1;
+        r.x2 = con->x2; r.y2 = con->y2;
+        r.t2 = con->t2;
+    }
+    ram_.push_back(r);
+    if (file_ && ram_.size() > ramRecords_) spillHalf();
+}
+
+// 记录定长，编号 i 在文件里的偏移就是 i * sizeof(Record)
+void DeltaStore::spillHalf() {
+    size_t k = ram_.size() / 2;
+    if (!seekTo(file_, (uint64_t)spilled_ * sizeof(Record)) ||
+        std::fwrite(ram_.data(), sizeof(Record), k, file_) != k) {
+        // 写失败（磁盘满等）：不再溢出，之后都留在内存里
+        std::fclose(file_);
+        file_ = nullptr;
+        return;
+    }
+    ram_.erase(ram_.begin(), ram_.begin() + k);
+    spilled_ += k;
+}
+
+bool DeltaStore::read(size_t id, Record& r) {
+    if (id >= spilled_) {
+        if (id >= size()) return false;
+        r = ram_[id - spilled_];
+        return true;
+    }
+    if (!file_) return false;
+    return seekTo(file_, (uint64_t)id * sizeof(Record)) &&
+           std::fread(&r, sizeof(Record), 1, file_) == 1;
+}
+
+bool DeltaStore::constraintsOf(int id, std::vector<Constraint>& out) {
+    out.clear();
+    Record r;
+    for (int cur = id; cur >= 0; cur = r.parent) {
+        if (!read((size_t)cur, r)) return false;
+        if (r.type < 0) continue;
+        Constraint c;
+        c.agent = r.agent;
+        c.type = (ConstraintType)r.type;
+        c.t = r.t;
+        c.x1 = r.x1; c.y1 = r.y1;
+        c.x2 = r.x2; c.y2 = r.y2;
+        c.t2 = r.t2;
+        out.push_back(c);
+    }
+    std::reverse(out.begin(), out.end());
+    return true;
+}
+
+} // namespace mapf
@@ -0,0 +1,209 @@
+#include "mapf/hierarchy.h"
+#include "mapf/motion_model.h"
+
+#include <queue>
+#include <utility>
+#include <algorithm>
+
+namespace mapf {
+
+MapHierarchy::MapHierarchy(const Grid& grid, int clusterSize)
+    : grid_(&grid), C_(std::max(clusterSize, 2)) {
+    ncx_ = (grid.W + C_ - 1) / C_;
+    ncy_ = (grid.H + C_ - 1) / C_;
+
+    std::unordered_map<int, int> index;    // 格子 -> 抽象节点
+    std::vector<std::vector<Edge>> out;
+
+    // 入口：每个簇只看右边界和下边界，每条边界只处理一次
+    for (int cy = 0; cy < ncy_; cy++) {
+        for (int cx = 0; cx < ncx_; cx++) {
+            int x0 = cx * C_, y0 = cy * C_;
+            int x1 = std::min(grid.W, x0 + C_), y1 = std::min(grid.H, y0 + C_);
+            if (x1 < grid.W) {
+                int run = 0;
+                for (int y = y0; y <= y1; y++) {
+                    if (y < y1 && grid.passable(x1 - 1, y) && grid.passable(x1, y)) { run++; continue; }
+                    if (run) addEntrances(x1 - 1, y - run, 0, 1, run, index, out);
+                    run = 0;
+                }
+            }
+            if (y1 < grid.H) {
+                int run = 0;
+                for (int x = x0; x <= x1; x++) {
+                    if (x < x1 && grid.passable(x, y1 - 1) && grid.passable(x, y1)) { run++; continue; }
+                    if (run) addEntrances(x - run, y1 - 1, 1, 0, run, index, out);
+                    run = 0;
+                }
+            }
+        }
+    }
+
+    // 按簇分桶
+    const int nc = ncx_ * ncy_;
+    clusterStart_.assign(nc + 1, 0);
+    for (const Pos& p : pos_) clusterStart_[clusterOf(p) + 1]++;
+    for (int c = 0; c < nc; c++) clusterStart_[c + 1] += clusterStart_[c];
+    clusterNodes_.resize(pos_.size());
+    std::vector<int> fill(clusterStart_.begin(), clusterStart_.end() - 1);
+    for (int u = 0; u < (int)pos_.size(); u++) clusterNodes_[fill[clusterOf(pos_[u])]++] = u;
+
+    // 簇内边：每个入口做一次簇内 BFS
+    std::vector<int> d;
+    for (int c = 0; c < nc; c++) {
+        for (int i = clusterStart_[c]; i < clusterStart_[c + 1]; i++) {
+            int u = clusterNodes_[i];
+            clusterBfs(pos_[u], d);
+            for (int j = clusterStart_[c]; j < clusterStart_[c + 1]; j++) {
+                int v = clusterNodes_[j];
+                int dv = d[local(pos_[v])];
+                if (v != u && dv >= 0) out[u].push_back(Edge{v, dv});
+            }
+        }
+    }
+
+    adjStart_.assign(pos_.size() + 1, 0);
+    for (size_t u = 0; u < pos_.size(); u++) {
+        adjStart_[u + 1] = adjStart_[u] + (int)out[u].size();
+        adj_.insert(adj_.end(), out[u].begin(), out[u].end());
+    }
+}
+
+int MapHierarchy::addNode(Pos p, std::unordered_map<int, int>& index) {
+    auto it = index.emplace(p.y * grid_->W + p.x, (int)pos_.size());
+    if (it.second) pos_.push_back(p);
+    return it.first->second;
+}
+
+// 一段长 len 的开口，从 (x, y) 沿 (dx, dy) 延伸，另一侧在 (+dy, +dx)；短开口取中点，长开口取两端
+void MapHierarchy::addEntrances(int x, int y, int dx, int dy, int len, std::unordered_map<int, int>& index,
+                                std::vector<std::vector<Edge>>& out) {
+    int picks[2] = {len / 2, -1};
+    if (len >= 6) { picks[0] = 0; picks[1] = len - 1; }
+    for (int i : picks) {
+        if (i < 0) continue;
+        Pos a{x + dx * i, y + dy * i};
+        int u = addNode(a, index);
+        int v = addNode(Pos{a.x + dy, a.y + dx}, index);
+        out.resize(pos_.size());
+        out[u].push_back(Edge{v, 1});
+        out[v].push_back(Edge{u, 1});
+    }
+}
+
+void MapHierarchy::clusterBfs(Pos src, std::vector<int>& d) const {
+    static constexpr int kDx[4] = {1, -1, 0, 0};
+    static constexpr int kDy[4] = {0, 0, 1, -1};
+    int x0 = src.x / C_ * C_, y0 = src.y / C_ * C_;
+    int x1 = std::min(grid_->W, x0 + C_), y1 = std::min(grid_->H, y0 + C_);
+
+    d.assign((size_t)C_ * C_, -1);
+    std::vector<Pos> q{src};
+    d[local(src)] = 0;
+    for (size_t h = 0; h < q.size(); h++) {
+        Pos p = q[h];
+        int dp = d[local(p)];
+        for (int k = 0; k < 4; k++) {
+            Pos n{p.x + kDx[k], p.y + kDy[k]};
+            if (n.x < x0 || n.x >= x1 || n.y < y0 || n.y >= y1 || !grid_->passable(n.x, n.y)) continue;
+            int& dn = d[local(n)];
+            if (dn >= 0) continue;
+            dn = dp + 1;
+            q.push_back(n);
+        }
+    }
+}
+
+// 起点、终点临时接到所在簇的入口上，在抽象图上做 A*；clusters 为路径经过的簇（可能重复）
+bool MapHierarchy::abstractPath(Pos start, Pos goal, std::vector<int>& clusters) const {
+    const int sc = clusterOf(start), gc = clusterOf(goal);
+    const int kGoal = (int)pos_.size();
+    std::vector<int> ds, dg;
+    clusterBfs(start, ds);
+    clusterBfs(goal, dg);
+
+    using Item = std::pair<int, int>;   // (f, 节点)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    std::unordered_map<int, int> g, parent;   // 只记访问到的节点，起点的 parent 为 -1
+    auto h = [&](int u) { return u == kGoal ? 0 : manhattan(pos_[u], goal); };
+    auto relax = [&](int v, int ng, int from) {
+        auto it = g.find(v);
+        if (it != g.end() && it->second <= ng) return;
+        g[v] = ng;
+        parent[v] = from;
+        open.push(Item{ng + h(v), v});
+    };
+
+    if (sc == gc && dg[local(start)] >= 0) relax(kGoal, dg[local(start)], -1);
+    for (int i = clusterStart_[sc]; i < clusterStart_[sc + 1]; i++) {
+        int u = clusterNodes_[i];
+        int du = ds[local(pos_[u])];
+        if (du >= 0) relax(u, du, -1);
+    }
+
+    while (!open.empty()) {
+        Item top = open.top(); open.pop();
+        int u = top.second, gu = g[u];
+        if (top.first != gu + h(u)) continue;   // 过期项
+        if (u == kGoal) {
+            clusters.assign(1, gc);
+            for (int v = parent[kGoal]; v >= 0; v = parent[v]) clusters.push_back(clusterOf(pos_[v]));
+            clusters.push_back(sc);
+            return true;
+        }
+        if (clusterOf(pos_[u]) == gc && dg[local(pos_[u])] >= 0) relax(kGoal, gu + dg[local(pos_[u])], u);
+        for (int e = adjStart_[u]; e < adjStart_[u + 1]; e++) relax(adj_[e].to, gu + adj_[e].cost, u);
+    }
+    return false;
+}
+
+// 从 goal 反向 Dijkstra，只在走廊内展开；两种模型的动作都是对称的，反向边与正向边代价相同
+template <class Model>
+void MapHierarchy::fillDistances(const Grid& grid, Pos goal, Corridor& cor) {
+    using Item = std::pair<int, int>;   // (距离, 格子)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    *cor.slot(goal.x, goal.y) = 0;
+    open.push(Item{0, goal.y * grid.W + goal.x});
+    while (!open.empty()) {
+        Item top = open.top(); open.pop();
+        int x = top.second % grid.W, y = top.second / grid.W;
+        if (top.first != cor.dist(x, y)) continue;
+        for (int k = 0; k + 1 < Model::kMoves; k++) {   // 最后一个动作是等待
+            if (!Model::canMove(grid, x, y, k)) continue;
+            int nx = x + Model::dx[k], ny = y + Model::dy[k];
+            int* s = cor.slot(nx, ny);
+            int nd = top.first + Model::cost[k];
+            if (!s || nd >= *s) continue;
+            *s = nd;
+            open.push(Item{nd, ny * grid.W + nx});
+        }
+    }
+}
+
+Corridor MapHierarchy::corridor(Pos start, Pos goal, MotionModel motion, int halo) const {
+    Corridor cor;
+    std::vector<int> path;
+    if (!grid_->passable(start.x, start.y) || !grid_->passable(goal.x, goal.y) ||
+        !abstractPath(start, goal, path))
+        return cor;
+
+    cor.C_ = C_;
+    cor.ncx_ = ncx_;
+    for (int c : path) {
+        int cx = c % ncx_, cy = c / ncx_;
+        for (int y = std::max(0, cy - halo); y <= std::min(ncy_ - 1, cy + halo); y++) {
+            for (int x = std::max(0, cx - halo); x <= std::min(ncx_ - 1, cx + halo); x++) {
+                int b = (int)cor.blocks_.size();
+                cor.blocks_.emplace(y * ncx_ + x, b);
+            }
+        }
+    }
+    cor.dist_.assign(cor.blocks_.size() * C_ * C_, Corridor::kUnreachable);
+
+    // 到终点的距离只和移动代价有关，等待代价不同的 8 连通模型共用一份
+    if (isEightConnected(motion)) fillDistances<EightConnected>(*grid_, goal, cor);
+    else                          fillDistances<FourConnected>(*grid_, goal, cor);
+    return cor;
+}
+
+} // namespace mapf
@@ -0,0 +1,123 @@
+#include "mapf/instance_io.h"
+#include "mapf/conflict.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+namespace mapf {
+
+namespace {
+
+bool fail(std::string* err, const std::string& msg) {
+    if (err) *err = msg;
+    return false;
+}
+
+char normalizeCell(char c) {
+    switch (c) {
+        case '@': case 'O': case 'T': case 'W': case '#': return '#';
+        default: return '.';
+    }
+}
+
+} // namespace
+
+bool readGrid(std::istream& in, Grid& grid, std::string* err) {
+    grid = Grid{};
+    std::string line;
+    std::vector<std::string> rows;
+    int H = -1, W = -1;
+    bool header = false;
+
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        std::istringstream ls(line);
+        std::string key;
+        ls >> key;
+        if (rows.empty() && (key == "type" || key == "height" || key == "width" || key == "map")) {
+            header = true;
+            if (key == "height") ls >> H;
+            if (key == "width")  ls >> W;
+            continue;
+        }
+        std::transform(line.begin(), line.end(), line.begin(), normalizeCell);
+        rows.push_back(line);
+        if (header && H >= 0 && (int)rows.size() == H) break;
+    }
+
+    if (rows.empty()) return fail(err, "empty map");
+    if (H < 0) H = (int)rows.size();
+    if (W < 0) W = (int)rows[0].size();
+    if ((int)rows.size() != H) return fail(err, "map height mismatch");
+    for (const auto& r : rows)
+        if ((int)r.size() != W) return fail(err, "map width mismatch");
+
+    grid.W = W;
+    grid.H = H;
+    grid.g = std::move(rows);
+    return true;
+}
+
+bool loadGrid(const std::string& path, Grid& grid, std::string* err) {
+    std::ifstream in(path);
+    if (!in) return fail(err, "cannot open map " + path);
+    return readGrid(in, grid, err);
+}
+
+bool parseInstance(const std::string& line, Instance& inst, std::string* err) {
+    inst = Instance{};
+    std::istringstream ls(line);
+    int n = 0;
+    if (!(ls >> inst.id >> inst.map >> n) || n < 0) return fail(err, "bad instance header");
+
+    inst.starts.resize(n);
+    inst.goals.resize(n);
+    for (int i = 0; i < n; i++) {
+        if (!(ls >> inst.starts[i].x >> inst.starts[i].y >> inst.goals[i].x >> inst.goals[i].y))
+            return fail(err, "expected " + std::to_string(n) + " agents");
+    }
+    return true;
+}
+
+std::string encodePath(const Path& p) {
+    if (p.empty()) return "-";
+    std::string s = std::to_string(p[0].x) + "," + std::to_string(p[0].y) + ":";
+    int len = pathCost(p);
+    for (int t = 1; t <= len; t++) {
+        int dx = p[t].x - p[t - 1].x, dy = p[t].y - p[t - 1].y;
+        if      (dx ==  1) s += 'R';
+        else if (dx == -1) s += 'L';
+        else if (dy ==  1) s += 'D';
+        else if (dy == -1) s += 'U';
+        else               s += 'W';
+    }
+    return s;
+}
+
+bool decodePath(const std::string& s, Path& p) {
+    p.clear();
+    Pos cur;
+    char comma = 0, colon = 0;
+    std::istringstream ls(s);
+    if (!(ls >> cur.x >> comma >> cur.y >> colon) || comma != ',' || colon != ':') return false;
+    p.push_back(cur);
+
+    char m;
+    while (ls.get(m)) {
+        switch (m) {
+            case 'R': cur.x++; break;
+            case 'L': cur.x--; break;
+            case 'D': cur.y++; break;
+            case 'U': cur.y--; break;
+            case 'W': break;
+            default: return false;
+        }
+        p.push_back(cur);
+    }
+    return true;
+}
+
+} // namespace mapf
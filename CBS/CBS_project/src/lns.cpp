@@ -0,0 +1,319 @@
+#include "mapf/lns.h"
+#include "mapf/low_level_astar.h"
+#include "mapf/conflict.h"
+#include "mapf/worker_pool.h"
+
+#include <random>
+#include <thread>
+#include <chrono>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+namespace mapf {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kKinds = 3;   // Random / AgentBased / MapBased
+
+void trimPath(Path& p) {
+    if (!p.empty()) p.resize(pathCost(p) + 1);
+}
+
+// 把别的 agent 的路径写进约束表：逐时刻的顶点、反向的交换边，到达后一直占住终点直到 H
+void reservePath(ConstraintTable& ct, const Path& p, int H) {
+    for (int t = 0; t <= H; t++) {
+        Pos cur = posAt(p, t);
+        ct.forbV.insert(keyVertex(cur.x, cur.y, t));
+        if (t < H) {
+            Pos nxt = posAt(p, t + 1);
+            if (!(nxt == cur)) ct.forbE.insert(keyEdge(nxt.x, nxt.y, cur.x, cur.y, t));
+        }
+    }
+}
+
+// 优先级规划修复：order 中的 agent 依次规划，其余 agent 的路径当作动态障碍。
+// 结果按 order 的顺序写入 out（已去掉末尾等待）；过了 deadline 就放弃，返回 false
+bool prioritizedRepair(const Grid& grid,
+                       const std::vector<Pos>& starts,
+                       const std::vector<Pos>& goals,
+                       const std::vector<Path>& paths,
+                       const std::vector<int>& order,
+                       Clock::time_point deadline,
+                       std::vector<Path>& out) {
+    int n = (int)starts.size();
+    std::vector<char> inN(n, 0);
+    for (int a : order) inN[a] = 1;
+
+    int H = 0;
+    for (int i = 0; i < n; i++) {
+        if (inN[i]) H = std::max(H, manhattan(starts[i], goals[i]));
+        else        H = std::max(H, (int)paths[i].size() - 1);
+    }
+    H += 10 + (int)order.size();
+
+    for (int attempt = 0; attempt < 3; attempt++, H += 10) {
+        ConstraintTable ct;
+        for (int i = 0; i < n; i++) if (!inN[i]) reservePath(ct, paths[i], H);
+
+        out.assign(order.size(), Path{});
+        bool ok = true;
+        for (size_t k = 0; k < order.size() && ok; k++) {
+            if (Clock::now() >= deadline) return false;
+            int a = order[k];
+            Path p = spaceTimeAStar(grid, starts[a], goals[a], H, ct);
+            if (p.empty()) { ok = false; break; }
+            trimPath(p);
+            reservePath(ct, p, H);
+            out[k] = std::move(p);
+        }
+        if (ok) return true;
+    }
+    return false;
+}
+
+// 每个格子被哪些 agent 经过（不区分时刻），供 agent/map 邻域使用
+using CellIndex = std::unordered_map<int, std::vector<int>>;
+
+CellIndex buildCellIndex(const Grid& grid, const std::vector<Path>& paths) {
+    CellIndex idx;
+    for (int i = 0; i < (int)paths.size(); i++) {
+        for (const auto& p : paths[i]) {
+            auto& v = idx[p.y * grid.W + p.x];
+            if (v.empty() || v.back() != i) v.push_back(i);
+        }
+    }
+    for (auto& kv : idx) {
+        auto& v = kv.second;
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    }
+    return idx;
+}
+
+int degree(const Grid& grid, int x, int y) {
+    return grid.passable(x + 1, y) + grid.passable(x - 1, y) +
+           grid.passable(x, y + 1) + grid.passable(x, y - 1);
+}
+
+void fillRandom(std::vector<int>& nb, std::vector<char>& used, int n, int k, std::mt19937& rng) {
+    std::vector<int> rest;
+    for (int i = 0; i < n; i++) if (!used[i]) rest.push_back(i);
+    std::shuffle(rest.begin(), rest.end(), rng);
+    for (int i = 0; i < (int)rest.size() && (int)nb.size() < k; i++) {
+        used[rest[i]] = 1;
+        nb.push_back(rest[i]);
+    }
+}
+
+std::vector<int> randomNeighborhood(int n, int k, std::mt19937& rng) {
+    std::vector<int> nb;
+    std::vector<char> used(n, 0);
+    fillRandom(nb, used, n, k, rng);
+    return nb;
+}
+
+// 按延迟加权挑一个 agent，再把路径上与它共用格子的 agent 加进来
+std::vector<int> agentNeighborhood(const Grid& grid,
+                                   const std::vector<Pos>& starts,
+                                   const std::vector<Pos>& goals,
+                                   const std::vector<Path>& paths,
+                                   const CellIndex& idx, int k, std::mt19937& rng) {
+    int n = (int)paths.size();
+    std::vector<double> w(n);
+    bool anyDelay = false;
+    for (int i = 0; i < n; i++) {
+        int d = pathCost(paths[i]) - manhattan(starts[i], goals[i]);
+        w[i] = d;
+        anyDelay |= d > 0;
+    }
+    if (!anyDelay) return randomNeighborhood(n, k, rng);
+
+    int seed = std::discrete_distribution<int>(w.begin(), w.end())(rng);
+    std::vector<int> nb{seed};
+    std::vector<char> used(n, 0);
+    used[seed] = 1;
+
+    std::vector<int> blockers;
+    for (const auto& p : paths[seed]) {
+        auto it = idx.find(p.y * grid.W + p.x);
+        if (it == idx.end()) continue;
+        for (int j : it->second) if (!used[j]) { used[j] = 1; blockers.push_back(j); }
+    }
+    std::shuffle(blockers.begin(), blockers.end(), rng);
+    for (int j : blockers) {
+        if ((int)nb.size() >= k) used[j] = 0;
+        else nb.push_back(j);
+    }
+    fillRandom(nb, used, n, k, rng);
+    return nb;
+}
+
+// 从一个随机路口（度数 >= 3 的格子）向外 BFS，收集经过这些格子的 agent
+std::vector<int> mapNeighborhood(const Grid& grid,
+                                 const std::vector<int>& junctions,
+                                 const CellIndex& idx, int n, int k, std::mt19937& rng) {
+    if (junctions.empty()) return randomNeighborhood(n, k, rng);
+
+    int c0 = junctions[std::uniform_int_distribution<int>(0, (int)junctions.size() - 1)(rng)];
+    std::vector<int> nb;
+    std::vector<char> used(n, 0);
+    std::unordered_set<int> seen{c0};
+    std::vector<int> q{c0};
+    const int dx[4] = {1,-1,0,0};
+    const int dy[4] = {0,0,1,-1};
+
+    for (size_t h = 0; h < q.size() && (int)nb.size() < k; h++) {
+        int c = q[h];
+        auto it = idx.find(c);
+        if (it != idx.end()) {
+            for (int j : it->second) {
+                if (used[j] || (int)nb.size() >= k) continue;
+                used[j] = 1;
+                nb.push_back(j);
+            }
+        }
+        int x = c % grid.W, y = c / grid.W;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d], ny = y + dy[d];
+            if (!grid.passable(nx, ny)) continue;
+            int nc = ny * grid.W + nx;
+            if (seen.insert(nc).second) q.push_back(nc);
+        }
+    }
+    fillRandom(nb, used, n, k, rng);
+    return nb;
+}
+
+struct Candidate {
+    int kind = 0;
+    bool valid = false;
+    int delta = 0;                 // 新代价 - 旧代价，< 0 才是改进
+    std::vector<int> agents;
+    std::vector<Path> paths;
+};
+
+} // namespace
+
+bool LNS(const Grid& grid,
+         const std::vector<Pos>& starts,
+         const std::vector<Pos>& goals,
+         std::vector<Path>& solution,
+         const LNSOptions& opt,
+         const LNSCallback& onImprove,
+         LNSStats* stats) {
+
+    auto deadline = Clock::now() + std::chrono::milliseconds(opt.timeLimitMs);
+    int n = (int)starts.size();
+    std::mt19937 rng(opt.seed);
+
+    // 初始解：沿用传入的可行解，否则用优先级规划（随机顺序重试）构造
+    std::vector<Path> cur;
+    bool built = false;
+    if ((int)solution.size() == n && !detectFirstConflict(solution).exists) {
+        cur = solution;
+        for (auto& p : cur) trimPath(p);
+    } else {
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<Path> none(n), planned;
+        while (!prioritizedRepair(grid, starts, goals, none, order, deadline, planned)) {
+            if (Clock::now() >= deadline) return false;
+            std::shuffle(order.begin(), order.end(), rng);
+        }
+        cur.assign(n, Path{});
+        for (int k = 0; k < n; k++) cur[order[k]] = std::move(planned[k]);
+        built = true;
+    }
+
+    LNSStats st;
+    int cost = sumOfCosts(cur);
+    st.initialCost = cost;
+
+    auto publish = [&]() {
+        solution = cur;
+        padPathsToSameLength(solution);
+        if (onImprove) onImprove(solution, cost);
+    };
+    if (built) publish();
+
+    int threads = opt.numThreads > 0 ? opt.numThreads
+                                     : std::max(1, (int)std::thread::hardware_concurrency());
+    int k = std::min(std::max(1, opt.neighborhoodSize), n);
+
+    std::vector<int> junctions;
+    for (int y = 0; y < grid.H; y++)
+        for (int x = 0; x < grid.W; x++)
+            if (grid.passable(x, y) && degree(grid, x, y) >= 3) junctions.push_back(y * grid.W + x);
+
+    // 自适应 LNS 的轮盘权重：按候选带来的改进量做指数平滑
+    double weights[kKinds] = {1.0, 1.0, 1.0};
+    const double reaction = 0.1;
+
+    for (int round = 0; n > 0 && Clock::now() < deadline; round++) {
+        int batch = threads;
+        if (opt.maxIterations > 0) batch = std::min(batch, opt.maxIterations - st.iterations);
+        if (batch <= 0) break;
+
+        CellIndex idx = buildCellIndex(grid, cur);
+        std::vector<Candidate> cands(batch);
+
+        auto evaluate = [&](int i) {
+            std::mt19937 r(opt.seed + 0x9e3779b9u * (unsigned)(round * threads + i + 1));
+            Candidate& c = cands[i];
+            if (opt.kind == NeighborhoodKind::Adaptive)
+                c.kind = std::discrete_distribution<int>(weights, weights + kKinds)(r);
+            else
+                c.kind = (int)opt.kind;
+
+            if (c.kind == (int)NeighborhoodKind::AgentBased)
+                c.agents = agentNeighborhood(grid, starts, goals, cur, idx, k, r);
+            else if (c.kind == (int)NeighborhoodKind::MapBased)
+                c.agents = mapNeighborhood(grid, junctions, idx, n, k, r);
+            else
+                c.agents = randomNeighborhood(n, k, r);
+
+            // 随机优先级顺序
+            std::shuffle(c.agents.begin(), c.agents.end(), r);
+            if (!prioritizedRepair(grid, starts, goals, cur, c.agents, deadline, c.paths)) return;
+
+            int before = 0, after = 0;
+            for (size_t j = 0; j < c.agents.size(); j++) {
+                before += pathCost(cur[c.agents[j]]);
+                after  += pathCost(c.paths[j]);
+            }
+            c.valid = true;
+            c.delta = after - before;
+        };
+
+        // 候选在调用线程和常驻线程池上评估，每轮不新建线程
+        WorkerPool::shared().runAll(batch, evaluate);
+        st.iterations += batch;
+
+        int best = -1;
+        for (int i = 0; i < batch; i++) {
+            const Candidate& c = cands[i];
+            double gain = c.valid ? std::max(0, -c.delta) : 0.0;
+            weights[c.kind] = std::max(0.01, (1 - reaction) * weights[c.kind] + reaction * gain);
+            if (c.valid && c.delta < 0 && (best < 0 || c.delta < cands[best].delta)) best = i;
+        }
+        if (best < 0) continue;
+
+        Candidate& c = cands[best];
+        for (size_t j = 0; j < c.agents.size(); j++) cur[c.agents[j]] = std::move(c.paths[j]);
+        cost += c.delta;
+        st.improvements++;
+        publish();
+    }
+
+    solution = cur;
+    padPathsToSameLength(solution);
+    st.finalCost = cost;
+    if (stats) *stats = st;
+    return true;
+}
+
+} // namespace mapf
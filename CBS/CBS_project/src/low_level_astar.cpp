@@ -1,5 +1,7 @@
 #include "mapf/low_level_astar.h"
+#include "mapf/hierarchy.h"
 #include <queue>
+#include <cstdint>
 #include <unordered_map>
 #include <algorithm>
 
@@ -15,18 +17,10 @@ struct StateHash {
     }
 };
 
-static std::vector<Pos> neighbors5(const Grid& grid, const Pos& cur) {
-    const int dx[5] = {1,-1,0,0,0};
-    const int dy[5] = {0,0,1,-1,0};
-    std::vector<Pos> res;
-    for (int k=0;k<5;k++){
-        int nx = cur.x + dx[k], ny = cur.y + dy[k];
-        if (grid.passable(nx,ny)) res.push_back(Pos{nx,ny});
-    }
-    return res;
-}
-
 static bool goalSafeToH(const ConstraintTable& ct, const Pos& goal, int t, int H) {
+    // 建表时已汇总终点约束（且都落在 H 内）：t 之后没有就安全
+    if (ct.goalCell == keyCell(goal.x, goal.y) && ct.goalVertexLast <= H && ct.goalWaitLast < H)
+        return ct.goalVertexLast < t && ct.goalWaitLast < t;
     for (int tau = t; tau <= H; ++tau) {
         if (violatesVertex(ct, goal.x, goal.y, tau)) return false;
         if (tau < H && violatesEdge(ct, goal.x, goal.y, goal.x, goal.y, tau)) return false; // 等待边
@@ -34,8 +28,12 @@ static bool goalSafeToH(const ConstraintTable& ct, const Pos& goal, int t, int H
     return true;
 }
 
-Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct) {
-    struct Node { State s; int g; int f; };
+// corridor 非空时只展开走廊内、能到达 goal 的格子，启发式用走廊内距离
+template <class Model>
+static Path search(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                   const Corridor* corridor, long long* expansions) {
+    using Cost = typename Model::Cost;
+    struct Node { State s; Cost g; Cost f; };
     struct Cmp {
         bool operator()(const Node& a, const Node& b) const {
             if (a.f != b.f) return a.f > b.f;
@@ -43,15 +41,19 @@ Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const Const
         }
     };
 
+    auto h = [&](int x, int y) -> Cost {
+        return corridor ? (Cost)corridor->dist(x, y) : Model::heuristic(Pos{x, y}, goal);
+    };
     if (violatesVertex(ct, start.x, start.y, 0)) return {};
+    if (corridor && corridor->dist(start.x, start.y) == Corridor::kUnreachable) return {};
 
     std::priority_queue<Node, std::vector<Node>, Cmp> open;
-    std::unordered_map<State, int, StateHash> bestG;
+    std::unordered_map<State, Cost, StateHash> bestG;
     std::unordered_map<State, State, StateHash> parent;
 
     State s0{start.x, start.y, 0};
     bestG[s0] = 0;
-    open.push(Node{s0, 0, manhattan(start, goal)});
+    open.push(Node{s0, 0, h(start.x, start.y)});
 
     while (!open.empty()) {
         Node cur = open.top(); open.pop();
@@ -59,6 +61,7 @@ Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const Const
 
         if (cur.g != bestG[cs]) continue;
         if (cs.t == maxT) continue;
+        if (expansions) ++*expansions;
 
         // 到达 goal：必须 goal-safe 才能返回
         if (cs.x == goal.x && cs.y == goal.y) {
@@ -77,20 +80,24 @@ Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const Const
             // 不安全：继续找其他到达方式/到达时刻
         }
 
-        for (const auto& np : neighbors5(grid, Pos{cs.x, cs.y})) {
+        // 动作表是编译期常量，循环会被展开
+        for (int k = 0; k < Model::kMoves; k++) {
+            if (!Model::canMove(grid, cs.x, cs.y, k)) continue;
+            int nx = cs.x + Model::dx[k], ny = cs.y + Model::dy[k];
             int nt = cs.t + 1;
 
-            if (violatesVertex(ct, np.x, np.y, nt)) continue;
-            if (violatesEdge(ct, cs.x, cs.y, np.x, np.y, cs.t)) continue;
+            if (violatesVertex(ct, nx, ny, nt)) continue;
+            if (violatesEdge(ct, cs.x, cs.y, nx, ny, cs.t)) continue;
+            if (corridor && corridor->dist(nx, ny) == Corridor::kUnreachable) continue;
 
-            State ns{np.x, np.y, nt};
-            int ng = cur.g + 1;
+            State ns{nx, ny, nt};
+            Cost ng = cur.g + Model::cost[k];
 
             auto it = bestG.find(ns);
             if (it == bestG.end() || ng < it->second) {
                 bestG[ns] = ng;
                 parent[ns] = cs;
-                int nf = ng + manhattan(Pos{ns.x, ns.y}, goal);
+                Cost nf = ng + h(nx, ny);
                 open.push(Node{ns, ng, nf});
             }
         }
@@ -98,4 +105,238 @@ Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const Const
     return {};
 }
 
+template <class Model>
+Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                    long long* expansions) {
+    return search<Model>(grid, start, goal, maxT, ct, nullptr, expansions);
+}
+
+template <class Model>
+Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                    const Corridor& corridor, long long* expansions) {
+    return search<Model>(grid, start, goal, maxT, ct, corridor.empty() ? nullptr : &corridor, expansions);
+}
+
+Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                    long long* expansions) {
+    return spaceTimeAStar<FourConnected>(grid, start, goal, maxT, ct, expansions);
+}
+
+template Path spaceTimeAStar<FourConnected>(const Grid&, Pos, Pos, int, const ConstraintTable&, long long*);
+template Path spaceTimeAStar<EightConnected>(const Grid&, Pos, Pos, int, const ConstraintTable&, long long*);
+template Path spaceTimeAStar<FourConnected>(const Grid&, Pos, Pos, int, const ConstraintTable&,
+                                            const Corridor&, long long*);
+template Path spaceTimeAStar<EightConnected>(const Grid&, Pos, Pos, int, const ConstraintTable&,
+                                             const Corridor&, long long*);
+template Path spaceTimeAStar<EightConnectedCheapWait>(const Grid&, Pos, Pos, int, const ConstraintTable&, long long*);
+template Path spaceTimeAStar<EightConnectedCheapWait>(const Grid&, Pos, Pos, int, const ConstraintTable&,
+                                                      const Corridor&, long long*);
+template Path spaceTimeAStar<EightConnectedCostlyWait>(const Grid&, Pos, Pos, int, const ConstraintTable&, long long*);
+template Path spaceTimeAStar<EightConnectedCostlyWait>(const Grid&, Pos, Pos, int, const ConstraintTable&,
+                                                       const Corridor&, long long*);
+
+// ===================== 增量搜索 =====================
+
+struct SearchTree {
+    // 槽位值：低 3 位是从前驱到达的动作（0..4，kRoot 表示起点），kExpanded 表示已扩展，kDead 表示已删除
+    static constexpr uint8_t kRoot = 7;
+    static constexpr uint8_t kMoveMask = 7;
+    static constexpr uint8_t kExpanded = 8;
+    static constexpr uint8_t kDead = 16;
+
+    Pos start, goal;
+    std::vector<uint64_t> keys;   // 0 表示空槽
+    std::vector<uint8_t> vals;
+    size_t used = 0;
+
+    static uint64_t key(int x, int y, int t) {
+        return (((uint64_t)t << 42) | ((uint64_t)y << 21) | (uint64_t)x) + 1;
+    }
+    static size_t mix(uint64_t k) {
+        k ^= k >> 33; k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33; k *= 0xc4ceb9fe1a85ec53ULL;
+        return (size_t)(k ^ (k >> 33));
+    }
+
+    uint8_t* find(int x, int y, int t) {
+        if (keys.empty()) return nullptr;
+        uint64_t k = key(x, y, t);
+        size_t mask = keys.size() - 1;
+        for (size_t i = mix(k) & mask;; i = (i + 1) & mask) {
+            if (keys[i] == k) return &vals[i];
+            if (keys[i] == 0) return nullptr;
+        }
+    }
+
+    // 返回槽位；新插入的槽位值为 kDead，由调用方写入
+    uint8_t& slot(int x, int y, int t) {
+        if ((used + 1) * 2 > keys.size()) grow();
+        uint64_t k = key(x, y, t);
+        size_t mask = keys.size() - 1;
+        size_t i = mix(k) & mask;
+        while (keys[i] != 0 && keys[i] != k) i = (i + 1) & mask;
+        if (keys[i] == 0) { keys[i] = k; vals[i] = kDead; used++; }
+        return vals[i];
+    }
+
+    void grow() {
+        std::vector<uint64_t> ok = std::move(keys);
+        std::vector<uint8_t> ov = std::move(vals);
+        keys.assign(std::max<size_t>(1024, ok.size() * 2), 0);
+        vals.assign(keys.size(), 0);
+        size_t mask = keys.size() - 1;
+        for (size_t j = 0; j < ok.size(); j++) {
+            if (ok[j] == 0) continue;
+            size_t i = mix(ok[j]) & mask;
+            while (keys[i] != 0) i = (i + 1) & mask;
+            keys[i] = ok[j];
+            vals[i] = ov[j];
+        }
+    }
+};
+
+static constexpr const int* kDX = FourConnected::dx;
+static constexpr const int* kDY = FourConnected::dy;
+
+static bool alive(const uint8_t* v) { return v && !(*v & SearchTree::kDead); }
+
+// (cx,cy,t) 原来的前驱失效：改挂到另一个已扩展、仍有效、且这条边没被禁止的前驱上，找不到返回 false
+static bool reparent(const Grid& grid, const ConstraintTable& ct, SearchTree& tr,
+                     int cx, int cy, int t, uint8_t* cv) {
+    for (int d = 0; d < 5; d++) {
+        int px = cx - kDX[d], py = cy - kDY[d];
+        if (!grid.passable(px, py)) continue;
+        const uint8_t* pv = tr.find(px, py, t - 1);
+        if (!alive(pv) || !(*pv & SearchTree::kExpanded)) continue;
+        if (violatesEdge(ct, px, py, cx, cy, t - 1)) continue;
+        *cv = uint8_t((*cv & ~SearchTree::kMoveMask) | d);
+        return true;
+    }
+    return false;
+}
+
+// 删掉状态 (x,y,t)，并把只能经由它到达的后继一并删掉
+static void cutState(const Grid& grid, const ConstraintTable& ct, SearchTree& tr, int x, int y, int t) {
+    uint8_t* v = tr.find(x, y, t);
+    if (!alive(v)) return;
+    *v = SearchTree::kDead;
+
+    std::vector<State> work{State{x, y, t}};
+    while (!work.empty()) {
+        State s = work.back(); work.pop_back();
+        for (int k = 0; k < 5; k++) {
+            int cx = s.x + kDX[k], cy = s.y + kDY[k];
+            uint8_t* cv = tr.find(cx, cy, s.t + 1);
+            if (!alive(cv) || (*cv & SearchTree::kMoveMask) != k) continue;
+            if (reparent(grid, ct, tr, cx, cy, s.t + 1, cv)) continue;
+            *cv = SearchTree::kDead;
+            work.push_back(State{cx, cy, s.t + 1});
+        }
+    }
+}
+
+// 用树里所有“已生成未扩展”的状态作为 open，继续 A*
+static Path resumeSearch(const Grid& grid, int maxT, const ConstraintTable& ct,
+                         SearchTree& tr, long long* expansions) {
+    struct Node { int x, y, t, f; };
+    struct Cmp {
+        bool operator()(const Node& a, const Node& b) const {
+            if (a.f != b.f) return a.f > b.f;
+            return a.t < b.t;
+        }
+    };
+    const Pos goal = tr.goal;
+
+    std::vector<Node> heap;
+    for (size_t i = 0; i < tr.keys.size(); i++) {
+        if (tr.keys[i] == 0 || (tr.vals[i] & (SearchTree::kDead | SearchTree::kExpanded))) continue;
+        uint64_t k = tr.keys[i] - 1;
+        int x = (int)(k & ((1u << 21) - 1));
+        int y = (int)((k >> 21) & ((1u << 21) - 1));
+        int t = (int)(k >> 42);
+        heap.push_back(Node{x, y, t, t + manhattan(Pos{x, y}, goal)});
+    }
+    std::priority_queue<Node, std::vector<Node>, Cmp> open(Cmp{}, std::move(heap));
+
+    while (!open.empty()) {
+        Node cur = open.top(); open.pop();
+        uint8_t* v = tr.find(cur.x, cur.y, cur.t);
+        if (!alive(v) || (*v & SearchTree::kExpanded)) continue;
+        if (cur.t >= maxT) continue;
+        if (expansions) ++*expansions;
+
+        if (cur.x == goal.x && cur.y == goal.y && goalSafeToH(ct, goal, cur.t, maxT)) {
+            std::vector<Pos> rev;
+            int x = cur.x, y = cur.y, t = cur.t;
+            while (true) {
+                rev.push_back(Pos{x, y});
+                uint8_t m = *tr.find(x, y, t) & SearchTree::kMoveMask;
+                if (m == SearchTree::kRoot) break;
+                x -= kDX[m]; y -= kDY[m]; t--;
+            }
+            std::reverse(rev.begin(), rev.end());
+            while ((int)rev.size() < maxT + 1) rev.push_back(rev.back());
+            return rev;
+        }
+        *v |= SearchTree::kExpanded;
+
+        for (int k = 0; k < 5; k++) {
+            int nx = cur.x + kDX[k], ny = cur.y + kDY[k], nt = cur.t + 1;
+            if (!grid.passable(nx, ny)) continue;
+            if (violatesVertex(ct, nx, ny, nt)) continue;
+            if (violatesEdge(ct, cur.x, cur.y, nx, ny, cur.t)) continue;
+
+            uint8_t& nv = tr.slot(nx, ny, nt);
+            if (!(nv & SearchTree::kDead)) continue;   // 已生成（g == t，不会更优）
+            nv = (uint8_t)k;
+            open.push(Node{nx, ny, nt, nt + manhattan(Pos{nx, ny}, goal)});
+        }
+    }
+    return {};
+}
+
+Path spaceTimeAStar(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                    std::shared_ptr<SearchTree>& tree, long long* expansions) {
+    tree = std::make_shared<SearchTree>();
+    tree->start = start;
+    tree->goal = goal;
+    if (violatesVertex(ct, start.x, start.y, 0)) return {};
+    tree->slot(start.x, start.y, 0) = SearchTree::kRoot;
+    return resumeSearch(grid, maxT, ct, *tree, expansions);
+}
+
+Path spaceTimeAStarIncremental(const Grid& grid, Pos start, Pos goal, int maxT, const ConstraintTable& ct,
+                               const Constraint* added,
+                               const std::shared_ptr<const SearchTree>& parent,
+                               std::shared_ptr<SearchTree>& tree,
+                               long long* expansions) {
+    if (!parent || !(parent->start == start) || !(parent->goal == goal) ||
+        (added && added->type != ConstraintType::Vertex && added->type != ConstraintType::Edge &&
+         added->type != ConstraintType::Range)) {
+        return spaceTimeAStar(grid, start, goal, maxT, ct, tree, expansions);
+    }
+
+    tree = std::make_shared<SearchTree>(*parent);
+    if (added) {
+        if (added->type == ConstraintType::Vertex) {
+            cutState(grid, ct, *tree, added->x1, added->y1, added->t);
+        } else if (added->type == ConstraintType::Range) {
+            // 区间约束：逐个时刻切掉，代价随区间长度线性增长
+            for (int t = added->t; t <= added->t2; t++) cutState(grid, ct, *tree, added->x1, added->y1, t);
+        } else {
+            // 边约束：只影响经由这条边挂在树上的那个状态
+            int x2 = added->x2, y2 = added->y2, t2 = added->t + 1;
+            uint8_t* v = tree->find(x2, y2, t2);
+            if (alive(v) && (*v & SearchTree::kMoveMask) != SearchTree::kRoot) {
+                uint8_t m = *v & SearchTree::kMoveMask;
+                if (x2 - kDX[m] == added->x1 && y2 - kDY[m] == added->y1 &&
+                    !reparent(grid, ct, *tree, x2, y2, t2, v)) {
+                    cutState(grid, ct, *tree, x2, y2, t2);
+                }
+            }
+        }
+    }
+    return resumeSearch(grid, maxT, ct, *tree, expansions);
+}
+
 } // namespace mapf
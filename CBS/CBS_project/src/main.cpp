@@ -1,10 +1,28 @@
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include "mapf/cbs.h"
 #include "mapf/conflict.h"
+#include "mapf/batch.h"
+#include "mapf/trace.h"
+#include "mapf/metrics.h"
+#include "mapf/validator.h"
+#include "mapf/instance_io.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <cstdio>
+#endif
 
 using namespace mapf;
 
-int main() {
+static int runDemo() {
     Grid grid;
     grid.g = {
         "..........",
@@ -36,3 +54,291 @@ int main() {
     }
     return 0;
 }
+
+static const char* kindName(ViolationKind k) {
+    switch (k) {
+        case ViolationKind::Vertex:   return "vertex";
+        case ViolationKind::Swap:     return "swap";
+        case ViolationKind::Crossing: return "crossing";
+        case ViolationKind::Obstacle: return "obstacle";
+        case ViolationKind::Jump:     return "jump";
+        case ViolationKind::Endpoint: return "endpoint";
+    }
+    return "?";
+}
+
+// 计划格式：每行一个 encodePath 路径，或一行里用 ';' 分隔；--batch 的输出行取 "paths=" 之后的部分
+static bool readPlan(std::istream& in, std::vector<Path>& paths) {
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t k = line.find("paths=");
+        if (k != std::string::npos) line = line.substr(k + 6);
+        else if (line.find('=') != std::string::npos) continue;   // 没有路径的 --batch 结果行
+        if (line.empty() || line[0] == '#') continue;
+        size_t b = 0;
+        while (b <= line.size()) {
+            size_t e = line.find(';', b);
+            if (e == std::string::npos) e = line.size();
+            std::string tok = line.substr(b, e - b);
+            while (!tok.empty() && (tok.back() == '\r' || tok.back() == ' ')) tok.pop_back();
+            if (!tok.empty()) {
+                Path p;
+                if (tok != "-" && !decodePath(tok, p)) {
+                    std::cerr << "bad path: " << tok << "\n";
+                    return false;
+                }
+                paths.push_back(p);
+            }
+            b = e + 1;
+        }
+    }
+    return true;
+}
+
+static int runValidate(const std::string& mapFile, const std::string& planFile, int threads, bool quiet) {
+    Grid grid;
+    std::string err;
+    if (!loadGrid(mapFile, grid, &err)) { std::cerr << "map: " << err << "\n"; return 2; }
+
+    std::ifstream fin;
+    std::istream* in = &std::cin;
+    if (!planFile.empty() && planFile != "-") {
+        fin.open(planFile);
+        if (!fin) { std::cerr << "cannot open " << planFile << "\n"; return 2; }
+        in = &fin;
+    }
+    std::vector<Path> paths;
+    if (!readPlan(*in, paths)) return 2;
+
+    ValidationOptions vo;
+    vo.threads = threads;
+    vo.maxSamples = quiet ? 0 : 20;
+    ValidationReport rep = validatePlan(grid, paths, vo);
+
+    std::cout << "valid=" << (rep.valid ? 1 : 0) << " agents=" << paths.size()
+              << " makespan=" << rep.perTimestep.size()
+              << " vertex=" << rep.vertex << " swap=" << rep.swap << " crossing=" << rep.crossing
+              << " obstacle=" << rep.obstacle << " jump=" << rep.jump
+              << " endpoint=" << rep.endpoint << " ms=" << rep.runtimeMs << "\n";
+    if (quiet || rep.valid) return rep.valid ? 0 : 1;
+
+    for (const auto& v : rep.samples) {
+        std::cout << "  " << kindName(v.kind) << " t=" << v.t << " a=" << v.a;
+        if (v.b >= 0) std::cout << " b=" << v.b;
+        std::cout << " at (" << v.pos.x << "," << v.pos.y << ")\n";
+    }
+    std::cout << "per-agent:";
+    for (size_t i = 0; i < rep.perAgent.size(); i++)
+        if (rep.perAgent[i]) std::cout << " " << i << ":" << rep.perAgent[i];
+    std::cout << "\nper-timestep:";
+    for (size_t t = 0; t < rep.perTimestep.size(); t++)
+        if (rep.perTimestep[t]) std::cout << " " << t << ":" << rep.perTimestep[t];
+    std::cout << "\n";
+    return 1;
+}
+
+// 后台导出在线性能计数：每 intervalSec 秒写一次文件，和/或在 socket 上按需提供快照；析构时停下并写最后一次
+class MetricsExporter {
+public:
+    MetricsExporter(const Metrics& m, const std::string& file, const std::string& socketPath, int intervalSec)
+        : m_(m), file_(file) {
+        if (!file_.empty())
+            threads_.emplace_back([this, intervalSec]() {
+                auto next = std::chrono::steady_clock::now();
+                while (!stop_.load()) {
+                    if (std::chrono::steady_clock::now() >= next) {
+                        dump();
+                        next += std::chrono::seconds(std::max(1, intervalSec));
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                }
+            });
+        if (!socketPath.empty())
+            threads_.emplace_back([this, socketPath]() {
+                std::string err;
+                if (!serveMetrics(m_, socketPath, &stop_, &err)) std::cerr << "metrics: " << err << "\n";
+            });
+    }
+    ~MetricsExporter() {
+        stop_.store(true);
+        for (auto& t : threads_) t.join();
+        if (!file_.empty()) dump();
+    }
+
+private:
+    void dump() {
+        std::string err;
+        if (!m_.dumpToFile(file_, &err)) std::cerr << "metrics: " << err << "\n";
+    }
+
+    const Metrics& m_;
+    std::string file_;
+    std::atomic<bool> stop_{false};
+    std::vector<std::thread> threads_;
+};
+
+static void usage() {
+    std::cerr <<
+        "usage: cbs                                  run the built-in demo\n"
+        "       cbs --batch [FILE|-] [options]       solve an instance stream (default stdin)\n"
+        "       cbs --serve SOCKET [options]         serve instance streams on a local socket\n"
+        "       cbs --validate MAP [PLAN|-]          check a plan (default stdin), exit 1 if invalid\n"
+        "options:\n"
+        "  --threads N        worker threads (default: hardware threads)\n"
+        "  --format text|bin  result format (default text)\n"
+        "  --time-limit MS    per-instance CBS time limit (default none)\n"
+        "  --cache N          low-level result cache entries (default 0 = off)\n"
+        "  --prune-dups       drop CT nodes whose constraint set was already generated\n"
+        "  --incremental      reuse the parent search tree when replanning an agent\n"
+        "  --disjoint         split conflicts with positive/negative constraint pairs\n"
+        "  --symmetry         resolve rectangle/corridor conflicts with barrier/range constraints\n"
+        "  --conflict RULE    conflict to split on: earliest|random|most (default earliest)\n"
+        "  --subopt W         bounded-suboptimal search, cost <= W * optimal (default 1)\n"
+        "  --seed N           random tie-break / conflict selection seed\n"
+        "  --portfolio        race the built-in solver portfolio per instance\n"
+        "  --memory-budget MB cap the RAM held by open CT nodes; colder nodes keep only constraint deltas\n"
+        "  --hierarchy C      plan inside cluster-graph corridors (C x C clusters); faster on large maps, not optimal\n"
+        "  --robust K         k-robust plans: no agent enters a cell another agent occupied in the last K steps\n"
+        "  --lns-ms MS        after CBS, improve the plan with LNS for MS ms; on CBS timeout, plan with LNS instead\n"
+        "  --no-paths         only write per-instance stats\n"
+        "  --out FILE         write results to FILE instead of stdout\n"
+        "  --trace FILE       --batch: record solver events and write them to FILE when the batch ends\n"
+        "  --trace-format F   json (Chrome trace, default) or bin\n"
+        "  --metrics FILE     keep FILE updated with Prometheus-format solver metrics\n"
+        "  --metrics-interval S  seconds between --metrics writes (default 10)\n"
+        "  --metrics-socket P serve the metrics snapshot on Unix socket P (plain text or HTTP GET)\n"
+        "  --quiet            --validate: only print the summary line\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return runDemo();
+
+    std::string mode = argv[1];
+    std::string target, plan, outFile, traceFile, metricsFile, metricsSocket;
+    int metricsInterval = 10;
+    bool traceBinary = false, quiet = false;
+    BatchOptions opt;
+
+    for (int i = 2; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) { usage(); std::exit(2); }
+            return argv[++i];
+        };
+        if      (a == "--threads")     opt.threads = std::atoi(next().c_str());
+        else if (a == "--format") {
+            std::string f = next();
+            if      (f == "text") opt.format = OutputFormat::Text;
+            else if (f == "bin")  opt.format = OutputFormat::Binary;
+            else { usage(); return 2; }
+        }
+        else if (a == "--time-limit")  opt.cbs.timeLimitMs = std::atoi(next().c_str());
+        else if (a == "--cache")       opt.cbs.lowLevelCacheCapacity = (size_t)std::atol(next().c_str());
+        else if (a == "--prune-dups")  opt.cbs.pruneDuplicateNodes = true;
+        else if (a == "--incremental") opt.cbs.incrementalLowLevel = true;
+        else if (a == "--disjoint")    opt.cbs.disjointSplitting = true;
+        else if (a == "--symmetry")    opt.cbs.symmetryReasoning = true;
+        else if (a == "--conflict") {
+            std::string r = next();
+            if      (r == "earliest") opt.cbs.conflictSelection = ConflictSelection::Earliest;
+            else if (r == "random")   opt.cbs.conflictSelection = ConflictSelection::Random;
+            else if (r == "most")     opt.cbs.conflictSelection = ConflictSelection::MostInvolved;
+            else { usage(); return 2; }
+        }
+        else if (a == "--subopt")      opt.cbs.suboptimality = std::atof(next().c_str());
+        else if (a == "--seed")        opt.cbs.seed = (unsigned)std::atol(next().c_str());
+        else if (a == "--portfolio")   opt.portfolio = true;
+        else if (a == "--memory-budget") opt.cbs.memoryBudgetBytes = (size_t)std::atol(next().c_str()) << 20;
+        else if (a == "--hierarchy")   opt.hierarchyClusterSize = std::atoi(next().c_str());
+        else if (a == "--robust")      opt.cbs.robustness = std::atoi(next().c_str());
+        else if (a == "--lns-ms")      opt.lnsMs = std::atoi(next().c_str());
+        else if (a == "--no-paths")    opt.writePaths = false;
+        else if (a == "--out")         outFile = next();
+        else if (a == "--trace")       traceFile = next();
+        else if (a == "--trace-format") {
+            std::string f = next();
+            if (f != "json" && f != "bin") { usage(); return 2; }
+            traceBinary = f == "bin";
+        }
+        else if (a == "--quiet")       quiet = true;
+        else if (a == "--metrics")     metricsFile = next();
+        else if (a == "--metrics-interval") metricsInterval = std::atoi(next().c_str());
+        else if (a == "--metrics-socket")   metricsSocket = next();
+        else if (target.empty() && (a == "-" || a[0] != '-')) target = a;
+        else if (mode == "--validate" && plan.empty() && (a == "-" || a[0] != '-')) plan = a;
+        else { usage(); return 2; }
+    }
+
+    // trace 文件在批处理结束时写；--serve 不会结束，--validate 不求解
+    if (!traceFile.empty() && mode != "--batch") {
+        std::cerr << "--trace is only supported with --batch\n";
+        return 2;
+    }
+    // LNS 只做普通（非 k-robust）的计划
+    if (opt.lnsMs > 0 && opt.cbs.robustness > 0) { usage(); return 2; }
+
+    std::unique_ptr<Metrics> metrics;
+    std::unique_ptr<MetricsExporter> exporter;
+    if (!metricsFile.empty() || !metricsSocket.empty()) {
+        metrics.reset(new Metrics());
+        opt.cbs.metrics = metrics.get();
+        exporter.reset(new MetricsExporter(*metrics, metricsFile, metricsSocket, metricsInterval));
+    }
+
+    if (mode == "--serve") {
+        if (target.empty()) { usage(); return 2; }
+        std::string err;
+        if (!serveBatch(target, opt, &err)) {
+            std::cerr << "serve: " << err << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (mode == "--validate") {
+        if (target.empty()) { usage(); return 2; }
+        return runValidate(target, plan, opt.threads, quiet);
+    }
+    if (mode != "--batch") { usage(); return 2; }
+
+    std::ifstream fin;
+    std::istream* in = &std::cin;
+    if (!target.empty() && target != "-") {
+        fin.open(target);
+        if (!fin) { std::cerr << "cannot open " << target << "\n"; return 1; }
+        in = &fin;
+    }
+    std::ofstream fout;
+    std::ostream* out = &std::cout;
+    if (!outFile.empty()) {
+        fout.open(outFile, std::ios::binary);
+        if (!fout) { std::cerr << "cannot open " << outFile << "\n"; return 1; }
+        out = &fout;
+    }
+#ifdef _WIN32
+    // Windows（MSYS/MinGW）的 stdout 默认是文本模式，会把 \n 写成 \r\n，二进制记录写 stdout 前先切到二进制模式
+    if (out == &std::cout && opt.format == OutputFormat::Binary) {
+        std::cout.flush();
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
+#endif
+
+    std::unique_ptr<Tracer> tracer;
+    if (!traceFile.empty()) {
+        tracer.reset(new Tracer());
+        opt.cbs.tracer = tracer.get();
+    }
+
+    MapCache maps;
+    BatchSummary sum = runBatch(*in, *out, opt, maps);
+    std::cerr << "[batch] instances=" << sum.instances << " solved=" << sum.solved
+              << " unsolved=" << sum.unsolved << " errors=" << sum.errors << "\n";
+
+    if (tracer) {
+        std::ofstream tf(traceFile, std::ios::binary);
+        if (!tf) { std::cerr << "cannot open " << traceFile << "\n"; return 1; }
+        if (traceBinary) tracer->writeBinary(tf);
+        else             tracer->writeChromeJson(tf);
+        std::cerr << "[trace] dropped=" << tracer->dropped() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,319 @@
+#include "mapf/metrics.h"
+#include "mapf/cbs.h"
+
+#include <ostream>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace mapf {
+
+namespace {
+
+enum Counter {
+    kSolved, kNoSolution, kTimeout, kCancelled,
+    kCtGenerated, kCacheHits, kCacheMisses, kCacheEvictions,
+    kDuplicatesPruned, kSymmetrySplits, kNodesSpilled, kNodesRestored,
+    kCorridorFallbacks, kWarmStartReused,
+    kCounters
+};
+
+enum Hist {
+    kSolveSeconds, kSolveCtNodes, kSolveExpansions, kSolveCacheHitRatio,
+    kLowLevelSeconds, kLowLevelExpansions,
+    kHists
+};
+
+struct CounterDef { const char* name; const char* label; const char* help; };
+const CounterDef kCounterDefs[kCounters] = {
+    {"mapf_solves_total", "result=\"solved\"", "CBS() calls by result."},
+    {"mapf_solves_total", "result=\"no_solution\"", nullptr},
+    {"mapf_solves_total", "result=\"timeout\"", nullptr},
+    {"mapf_solves_total", "result=\"cancelled\"", nullptr},
+    {"mapf_ct_nodes_generated_total", nullptr, "CT nodes pushed to the open list."},
+    {"mapf_cache_hits_total", nullptr, "Low-level result cache hits."},
+    {"mapf_cache_misses_total", nullptr, "Low-level result cache misses."},
+    {"mapf_cache_evictions_total", nullptr, "Low-level result cache evictions."},
+    {"mapf_duplicates_pruned_total", nullptr, "CT nodes dropped as duplicates."},
+    {"mapf_symmetry_splits_total", nullptr, "Splits on rectangle/corridor conflicts."},
+    {"mapf_nodes_spilled_total", nullptr, "CT nodes demoted to constraint deltas under the memory budget."},
+    {"mapf_nodes_restored_total", nullptr, "Cold CT nodes rebuilt from constraint deltas."},
+    {"mapf_corridor_fallbacks_total", nullptr, "Low-level searches that left the hierarchy corridor."},
+    {"mapf_warm_start_reused_total", nullptr, "Agents whose warm-start path was reused at the root."},
+};
+
+struct HistDef { const char* name; const char* help; std::vector<double> bounds; };
+const HistDef kHistDefs[kHists] = {
+    {"mapf_solve_duration_seconds", "Wall time of one CBS() call.",
+     {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60}},
+    {"mapf_solve_ct_nodes_expanded", "CT nodes expanded by one CBS() call.",
+     {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 100000}},
+    {"mapf_solve_low_level_expansions", "Low-level A* expansions in one CBS() call.",
+     {100, 1000, 10000, 100000, 1e6, 1e7, 1e8}},
+    {"mapf_solve_cache_hit_ratio", "Low-level cache hit ratio of one CBS() call (only calls that used the cache).",
+     {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 0.95, 0.99}},
+    {"mapf_low_level_duration_seconds", "Wall time of one low-level search.",
+     {1e-5, 5e-5, 1e-4, 5e-4, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1}},
+    {"mapf_low_level_expansions", "States expanded by one low-level search.",
+     {10, 100, 1000, 10000, 100000, 1e6}},
+};
+
+// 分片里的槽位：先是计数器，之后每个直方图占 (桶数 + 1) 个槽（最后一个是 +Inf）
+struct Layout {
+    size_t offset[kHists];
+    size_t slots;
+    Layout() {
+        slots = kCounters;
+        for (int h = 0; h < kHists; h++) {
+            offset[h] = slots;
+            slots += kHistDefs[h].bounds.size() + 1;
+        }
+    }
+};
+const Layout& layout() {
+    static const Layout l;
+    return l;
+}
+
+// 每个槽位只有所属线程写，读改写不需要原子加
+inline void bump(std::atomic<uint64_t>& c, uint64_t v = 1) {
+    c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+std::string fmt(double v) {
+    char b[32];
+    std::snprintf(b, sizeof(b), "%.9g", v);
+    return b;
+}
+
+} // namespace
+
+struct Metrics::Shard {
+    Shard() : counts(layout().slots), sums(kHists) {
+        for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+        for (auto& s : sums) s.store(0, std::memory_order_relaxed);
+    }
+
+    void observe(int h, double v) {
+        const auto& b = kHistDefs[h].bounds;
+        size_t i = 0;
+        while (i < b.size() && v > b[i]) i++;
+        bump(counts[layout().offset[h] + i]);
+        sums[h].store(sums[h].load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+    std::vector<std::atomic<uint64_t>> counts;
+    std::vector<std::atomic<double>> sums;
+};
+
+Metrics::Metrics()
+    : retiredCounts_(layout().slots, 0),
+      retiredSums_(kHists, 0),
+      slots_([this]() -> void* {
+                 std::lock_guard<std::mutex> lock(mu_);
+                 shards_.emplace_back(new Shard());
+                 return shards_.back().get();
+             },
+             [this](void* p) {
+                 // 并入汇总和摘掉分片在同一把锁下，导出不会重复计或漏计
+                 Shard* s = static_cast<Shard*>(p);
+                 std::lock_guard<std::mutex> lock(mu_);
+                 for (size_t i = 0; i < retiredCounts_.size(); i++)
+                     retiredCounts_[i] += s->counts[i].load(std::memory_order_relaxed);
+                 for (int h = 0; h < kHists; h++) retiredSums_[h] += s->sums[h].load(std::memory_order_relaxed);
+                 for (size_t i = 0; i < shards_.size(); i++)
+                     if (shards_[i].get() == s) {
+                         shards_[i] = std::move(shards_.back());
+                         shards_.pop_back();
+                         break;
+                     }
+             }) {}
+
+Metrics::~Metrics() = default;
+
+Metrics::Shard* Metrics::localShard() {
+    return static_cast<Shard*>(slots_.local());
+}
+
+size_t Metrics::shardCount() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return shards_.size();
+}
+
+void Metrics::recordSolve(const CBSStats& st, bool solved) {
+    Shard* s = localShard();
+    bump(s->counts[solved ? kSolved : st.timedOut ? kTimeout : st.cancelled ? kCancelled : kNoSolution]);
+    bump(s->counts[kCtGenerated], (uint64_t)st.ctGenerated);
+    bump(s->counts[kCacheHits], (uint64_t)st.cacheHits);
+    bump(s->counts[kCacheMisses], (uint64_t)st.cacheMisses);
+    bump(s->counts[kCacheEvictions], (uint64_t)st.cacheEvictions);
+    bump(s->counts[kDuplicatesPruned], (uint64_t)st.duplicatesPruned);
+    bump(s->counts[kSymmetrySplits], (uint64_t)st.symmetrySplits);
+    bump(s->counts[kNodesSpilled], (uint64_t)st.nodesSpilled);
+    bump(s->counts[kNodesRestored], (uint64_t)st.nodesRestored);
+    bump(s->counts[kCorridorFallbacks], (uint64_t)st.corridorFallbacks);
+    bump(s->counts[kWarmStartReused], (uint64_t)st.warmStartReused);
+
+    s->observe(kSolveSeconds, st.runtimeMs / 1000.0);
+    s->observe(kSolveCtNodes, (double)st.ctExpanded);
+    s->observe(kSolveExpansions, (double)st.lowLevelExpansions);
+    long long lookups = st.cacheHits + st.cacheMisses;
+    if (lookups > 0) s->observe(kSolveCacheHitRatio, (double)st.cacheHits / (double)lookups);
+}
+
+void Metrics::recordLowLevel(long long expansions, double seconds) {
+    Shard* s = localShard();
+    s->observe(kLowLevelSeconds, seconds);
+    s->observe(kLowLevelExpansions, (double)expansions);
+}
+
+void Metrics::sum(std::vector<uint64_t>& counts, std::vector<double>& sums) const {
+    std::lock_guard<std::mutex> lock(mu_);
+    counts = retiredCounts_;
+    sums = retiredSums_;
+    for (const auto& s : shards_) {
+        for (size_t i = 0; i < counts.size(); i++) counts[i] += s->counts[i].load(std::memory_order_relaxed);
+        for (int h = 0; h < kHists; h++) sums[h] += s->sums[h].load(std::memory_order_relaxed);
+    }
+}
+
+void Metrics::writePrometheus(std::ostream& out) const {
+    std::vector<uint64_t> c;
+    std::vector<double> sums;
+    sum(c, sums);
+
+    for (int i = 0; i < kCounters; i++) {
+        const CounterDef& d = kCounterDefs[i];
+        if (d.help) out << "# HELP " << d.name << ' ' << d.help << "\n# TYPE " << d.name << " counter\n";
+        out << d.name;
+        if (d.label) out << '{' << d.label << '}';
+        out << ' ' << c[i] << '\n';
+    }
+
+    // 整个进程生命周期的缓存命中率，面板上不用自己算
+    uint64_t lookups = c[kCacheHits] + c[kCacheMisses];
+    out << "# HELP mapf_cache_hit_ratio Low-level cache hits / lookups since start.\n"
+           "# TYPE mapf_cache_hit_ratio gauge\n"
+        << "mapf_cache_hit_ratio " << fmt(lookups ? (double)c[kCacheHits] / (double)lookups : 0) << '\n';
+
+    for (int h = 0; h < kHists; h++) {
+        const HistDef& d = kHistDefs[h];
+        out << "# HELP " << d.name << ' ' << d.help << "\n# TYPE " << d.name << " histogram\n";
+        size_t off = layout().offset[h];
+        uint64_t cum = 0;
+        for (size_t i = 0; i < d.bounds.size(); i++) {
+            cum += c[off + i];
+            out << d.name << "_bucket{le=\"" << fmt(d.bounds[i]) << "\"} " << cum << '\n';
+        }
+        cum += c[off + d.bounds.size()];
+        out << d.name << "_bucket{le=\"+Inf\"} " << cum << '\n'
+            << d.name << "_sum " << fmt(sums[h]) << '\n'
+            << d.name << "_count " << cum << '\n';
+    }
+}
+
+std::string Metrics::prometheusText() const {
+    std::ostringstream ss;
+    writePrometheus(ss);
+    return ss.str();
+}
+
+bool Metrics::dumpToFile(const std::string& path, std::string* err) const {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) {
+            if (err) *err = "cannot open " + tmp;
+            return false;
+        }
+        writePrometheus(f);
+        if (!f.flush()) {
+            if (err) *err = "cannot write " + tmp;
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        if (err) *err = "cannot rename " + tmp + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool serveMetrics(const Metrics& metrics, const std::string& socketPath,
+                  const std::atomic<bool>* stop, std::string* err) {
+#ifdef _WIN32
+    (void)metrics; (void)socketPath; (void)stop;
+    if (err) *err = "metrics socket is not supported on this platform, use dumpToFile";
+    return false;
+#else
+    auto fail = [&](const std::string& what) {
+        if (err) *err = what + ": " + std::strerror(errno);
+        return false;
+    };
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        if (err) *err = "socket path too long";
+        return false;
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int lfd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0) return fail("socket");
+    ::unlink(socketPath.c_str());
+    if (::bind(lfd, (sockaddr*)&addr, sizeof(addr)) < 0) { ::close(lfd); return fail("bind"); }
+    if (::listen(lfd, 16) < 0) { ::close(lfd); return fail("listen"); }
+
+    while (!stop || !stop->load(std::memory_order_relaxed)) {
+        pollfd pl{lfd, POLLIN, 0};
+        int r = ::poll(&pl, 1, 200);
+        if (r < 0 && errno != EINTR) { ::close(lfd); return fail("poll"); }
+        if (r <= 0) continue;
+        int cfd = ::accept(lfd, nullptr, nullptr);
+        if (cfd < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            ::close(lfd);
+            return fail("accept");
+        }
+
+        // 等一小会儿看客户端是不是先发了 HTTP 请求
+        char req[1024];
+        ssize_t k = 0;
+        pollfd pc{cfd, POLLIN, 0};
+        if (::poll(&pc, 1, 100) > 0) k = ::recv(cfd, req, sizeof(req), 0);
+        bool http = k >= 4 && std::memcmp(req, "GET ", 4) == 0;
+
+        std::string body = metrics.prometheusText();
+        std::string msg;
+        if (http)
+            msg = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                  std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+        msg += body;
+        for (size_t p = 0; p < msg.size();) {
+#ifdef MSG_NOSIGNAL
+            ssize_t w = ::send(cfd, msg.data() + p, msg.size() - p, MSG_NOSIGNAL);
+#else
+            ssize_t w = ::send(cfd, msg.data() + p, msg.size() - p, 0);
+#endif
+            if (w <= 0) break;
+            p += (size_t)w;
+        }
+        ::close(cfd);
+    }
+    ::close(lfd);
+    ::unlink(socketPath.c_str());
+    return true;
+#endif
+}
+
+} // namespace mapf
@@ -0,0 +1,150 @@
+#include "mapf/path_cache.h"
+#include "mapf/conflict.h"
+
+#include <tuple>
+#include <algorithm>
+
+namespace mapf {
+
+namespace {
+
+uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t hashCombine(uint64_t h, uint64_t v) {
+    return mix64(h ^ mix64(v));
+}
+
+auto asTuple(const Constraint& c) {
+    return std::make_tuple(c.agent, c.t, (int)c.type, c.x1, c.y1, c.x2, c.y2, c.t2);
+}
+
+bool constraintLess(const Constraint& a, const Constraint& b) {
+    return asTuple(a) < asTuple(b);
+}
+
+bool constraintEqual(const Constraint& a, const Constraint& b) {
+    return asTuple(a) == asTuple(b);
+}
+
+uint64_t hashConstraint(uint64_t h, const Constraint& c) {
+    h = hashCombine(h, ((uint64_t)(uint32_t)c.agent << 32) | (uint32_t)c.t);
+    h = hashCombine(h, ((uint64_t)(uint32_t)c.type << 32) | (uint32_t)c.x1);
+    h = hashCombine(h, ((uint64_t)(uint32_t)c.y1 << 32) | (uint32_t)c.x2);
+    return hashCombine(h, ((uint64_t)(uint32_t)c.y2 << 32) | (uint32_t)c.t2);
+}
+
+void canonicalize(std::vector<Constraint>& cons) {
+    std::sort(cons.begin(), cons.end(), constraintLess);
+    cons.erase(std::unique(cons.begin(), cons.end(), constraintEqual), cons.end());
+}
+
+// (dx+1)*3 + (dy+1)，4 连通和 8 连通的动作都能表示
+uint8_t encodeMove(const Pos& a, const Pos& b) {
+    return uint8_t((b.x - a.x + 1) * 3 + (b.y - a.y + 1));
+}
+
+} // namespace
+
+bool LowLevelKey::operator==(const LowLevelKey& o) const {
+    if (hash != o.hash || agent != o.agent || maxT != o.maxT || cons.size() != o.cons.size()) return false;
+    for (size_t i = 0; i < cons.size(); i++)
+        if (!constraintEqual(cons[i], o.cons[i])) return false;
+    return true;
+}
+
+// 约束排序去重后算哈希
+static void finishKey(LowLevelKey& k) {
+    canonicalize(k.cons);
+    uint64_t h = hashCombine((uint64_t)(uint32_t)k.agent, (uint64_t)(uint32_t)k.maxT);
+    for (const auto& c : k.cons) h = hashConstraint(h, c);
+    k.hash = h;
+}
+
+LowLevelKey makeLowLevelKey(const std::vector<Constraint>& cons, int agent, int maxT) {
+    LowLevelKey k;
+    k.agent = agent;
+    k.maxT = maxT;
+    // 其他 agent 的正约束也会限制本 agent，一并算进键里
+    for (const auto& c : cons)
+        if (c.agent == agent || isPositive(c.type)) k.cons.push_back(c);
+    finishKey(k);
+    return k;
+}
+
+LowLevelKey makeLowLevelKey(const std::vector<Constraint>& cons, const ConstraintIndex& idx, int agent, int maxT) {
+    LowLevelKey k;
+    k.agent = agent;
+    k.maxT = maxT;
+    for (int i : idx.own[agent]) k.cons.push_back(cons[i]);
+    for (int i : idx.positives)
+        if (cons[i].agent != agent) k.cons.push_back(cons[i]);
+    finishKey(k);
+    return k;
+}
+
+NodeFingerprint fingerprintConstraints(const std::vector<Constraint>& cons) {
+    std::vector<Constraint> sorted = cons;
+    canonicalize(sorted);
+    NodeFingerprint f;
+    f.h1 = 0x243f6a8885a308d3ULL;
+    f.h2 = 0x13198a2e03707344ULL;
+    for (const auto& c : sorted) {
+        f.h1 = hashConstraint(f.h1, c);
+        f.h2 = hashConstraint(f.h2 ^ 0xa4093822299f31d0ULL, c);
+    }
+    return f;
+}
+
+bool PathCache::lookup(const LowLevelKey& key, Path& path) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        stats_.misses++;
+        return false;
+    }
+    stats_.hits++;
+    Entry& e = it->second;
+    lru_.splice(lru_.begin(), lru_, e.lruPos);
+
+    path.clear();
+    if (!e.found) return true;
+    Pos cur = e.start;
+    path.reserve(key.maxT + 1);
+    path.push_back(cur);
+    for (uint8_t m : e.moves) {
+        cur.x += m / 3 - 1;
+        cur.y += m % 3 - 1;
+        path.push_back(cur);
+    }
+    while ((int)path.size() < key.maxT + 1) path.push_back(cur);
+    return true;
+}
+
+void PathCache::insert(const LowLevelKey& key, const Path& path) {
+    if (capacity_ == 0 || entries_.count(key)) return;
+
+    while (entries_.size() >= capacity_) {
+        const LowLevelKey* victim = lru_.back();
+        lru_.pop_back();
+        entries_.erase(entries_.find(*victim));
+        stats_.evictions++;
+    }
+
+    auto res = entries_.emplace(key, Entry{});
+    Entry& e = res.first->second;
+    e.found = !path.empty();
+    if (e.found) {
+        e.start = path.front();
+        int len = pathCost(path);
+        e.moves.reserve(len);
+        for (int t = 1; t <= len; t++) e.moves.push_back(encodeMove(path[t - 1], path[t]));
+    }
+    lru_.push_front(&res.first->first);
+    e.lruPos = lru_.begin();
+}
+
+} // namespace mapf
@@ -0,0 +1,163 @@
+#include "mapf/portfolio.h"
+#include "mapf/conflict.h"
+#include "mapf/validator.h"
+#include "mapf/worker_pool.h"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <ostream>
+#include <algorithm>
+
+namespace mapf {
+
+std::vector<PortfolioVariant> defaultPortfolio(double maxSuboptimality) {
+    std::vector<PortfolioVariant> all;
+    auto add = [&](const char* name, CBSOptions o) { all.push_back(PortfolioVariant{name, o}); };
+
+    CBSOptions o;
+    add("cbs", o);
+
+    o = CBSOptions{};
+    o.incrementalLowLevel = true;
+    o.disjointSplitting = true;
+    o.symmetryReasoning = true;
+    o.pruneDuplicateNodes = true;
+    add("cbs-dsym-incr", o);
+
+    o = CBSOptions{};
+    o.symmetryReasoning = true;
+    o.conflictSelection = ConflictSelection::MostInvolved;
+    o.lowLevelCacheCapacity = 4096;
+    add("cbs-most-cache", o);
+
+    o = CBSOptions{};
+    o.incrementalLowLevel = true;
+    o.conflictSelection = ConflictSelection::Random;
+    o.seed = 1;
+    add("cbs-rand-s1", o);
+
+    o = CBSOptions{};
+    o.incrementalLowLevel = true;
+    o.symmetryReasoning = true;
+    o.suboptimality = 1.05;
+    add("bcbs-1.05", o);
+
+    o = CBSOptions{};
+    o.incrementalLowLevel = true;
+    o.conflictSelection = ConflictSelection::MostInvolved;
+    o.suboptimality = 1.2;
+    o.seed = 2;
+    add("bcbs-1.2", o);
+
+    o = CBSOptions{};
+    o.incrementalLowLevel = true;
+    o.conflictSelection = ConflictSelection::Random;
+    o.suboptimality = 1.5;
+    o.seed = 3;
+    add("bcbs-1.5", o);
+
+    std::vector<PortfolioVariant> out;
+    for (auto& v : all)
+        if (v.cbs.suboptimality <= maxSuboptimality + 1e-9) out.push_back(std::move(v));
+    return out;
+}
+
+bool portfolioCBS(const Grid& grid,
+                  const std::vector<Pos>& starts,
+                  const std::vector<Pos>& goals,
+                  std::vector<Path>& solution,
+                  const PortfolioOptions& opt,
+                  PortfolioStats* stats) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+
+    std::vector<PortfolioVariant> variants;
+    for (const auto& v : opt.variants.empty() ? defaultPortfolio(opt.maxSuboptimality) : opt.variants)
+        if (v.cbs.suboptimality <= opt.maxSuboptimality + 1e-9) variants.push_back(v);
+    int cap = opt.maxThreads > 0 ? opt.maxThreads
+                                 : std::max(1, (int)std::thread::hardware_concurrency());
+
+    PortfolioStats ps;
+    int k = (int)variants.size();
+    int workers = std::max(1, std::min(k, cap));
+    ps.variantStats.resize(k);
+    for (const auto& v : variants) ps.names.push_back(v.name);
+
+    std::atomic<bool> stop{false};
+    std::mutex mu;
+    std::vector<Path> best;
+
+    auto run = [&](int i) {
+        CBSOptions o = variants[i].cbs;
+        o.cancel = &stop;
+        if (opt.timeLimitMs > 0) {
+            // 整体时间上限：排队晚启动的配置只拿剩下的时间
+            int left = opt.timeLimitMs - (int)std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            if (left <= 0) return;
+            if (o.timeLimitMs <= 0 || left < o.timeLimitMs) o.timeLimitMs = left;
+        }
+
+        std::vector<Path> paths;
+        CBSStats st;
+        bool ok = CBS(grid, starts, goals, paths, o, &st);
+        // 解要先过校验再算赢，避免某个配置的缺陷把错误结果带出去
+        if (ok) {
+            ValidationOptions vo;
+            vo.threads = 1;
+            vo.motion = o.motion;
+            vo.maxSamples = 0;
+            vo.starts = &starts;
+            vo.goals = &goals;
+            ok = paths.size() == starts.size() && validatePlan(grid, paths, vo).valid;
+        }
+
+        std::lock_guard<std::mutex> lock(mu);
+        ps.variantStats[i] = st;
+        if (ok && ps.winner < 0) {
+            ps.winner = i;
+            best = std::move(paths);
+            stop.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    // 配置比线程多时排队：每个线程跑完一个（没解出）就取下一个，有配置胜出后剩下的直接跳过
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            int i = next.fetch_add(1);
+            if (i >= k) break;
+            run(i);
+        }
+    };
+    // 调用线程自己也跑一份，其余交给常驻线程池
+    WorkerPool::shared().runAll(workers, [&](int) { worker(); });
+
+    ps.runtimeMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    if (ps.winner >= 0) {
+        ps.winnerName = variants[ps.winner].name;
+        ps.winnerStats = ps.variantStats[ps.winner];
+        solution = std::move(best);
+    }
+
+    if (opt.log) {
+        std::ostream& log = *opt.log;
+        log << "portfolio winner=" << (ps.winner >= 0 ? ps.winnerName : std::string("none"))
+            << " variants=" << k
+            << " threads=" << workers
+            << " ms=" << ps.runtimeMs;
+        if (ps.winner >= 0)
+            log << " soc=" << sumOfCosts(solution, variants[ps.winner].cbs.motion)
+                << " expanded=" << ps.winnerStats.ctExpanded
+                << " llcalls=" << ps.winnerStats.lowLevelCalls;
+        log << '\n';
+        log.flush();
+    }
+
+    bool ok = ps.winner >= 0;
+    if (stats) *stats = std::move(ps);
+    return ok;
+}
+
+} // namespace mapf
@@ -0,0 +1,196 @@
+#include "mapf/symmetry.h"
+
+#include <deque>
+#include <climits>
+#include <algorithm>
+
+namespace mapf {
+
+static int sign(int v) { return (v > 0) - (v < 0); }
+
+static int degree(const Grid& grid, const Pos& p) {
+    return grid.passable(p.x + 1, p.y) + grid.passable(p.x - 1, p.y) +
+           grid.passable(p.x, p.y + 1) + grid.passable(p.x, p.y - 1);
+}
+
+static bool pathViolates(const Path& path, const Constraint& c) {
+    if (c.type == ConstraintType::Range) {
+        for (int t = c.t; t <= c.t2; t++)
+            if (posAt(path, t) == Pos{c.x1, c.y1}) return true;
+        return false;
+    }
+    // Barrier
+    int dx = sign(c.x2 - c.x1), dy = sign(c.y2 - c.y1);
+    int len = std::abs(c.x2 - c.x1) + std::abs(c.y2 - c.y1);
+    for (int i = 0; i <= len; i++)
+        if (posAt(path, c.t + i) == Pos{c.x1 + i * dx, c.y1 + i * dy}) return true;
+    return false;
+}
+
+bool rectangleConstraints(const std::vector<Pos>& starts,
+                          const std::vector<Pos>& goals,
+                          const std::vector<Path>& paths,
+                          const Conflict& conf,
+                          Constraint out[2],
+                          int k) {
+    if (!conf.exists || conf.isEdge) return false;
+    int a1 = conf.a, a2 = conf.b;
+    Pos s1 = starts[a1], g1 = goals[a1], s2 = starts[a2], g2 = goals[a2];
+
+    // 两条路径都必须是无等待的最短路
+    if (pathCost(paths[a1]) != manhattan(s1, g1) || pathCost(paths[a2]) != manhattan(s2, g2)) return false;
+
+    int sx = sign(g1.x - s1.x), sy = sign(g1.y - s1.y);
+    if (sx == 0 || sy == 0 || sign(g2.x - s2.x) != sx || sign(g2.y - s2.y) != sy) return false;
+
+    // 翻转坐标，使两个 agent 都朝 +x、+y 前进（sx、sy 为 ±1，翻两次还原）
+    auto flip = [&](Pos p) { return Pos{p.x * sx, p.y * sy}; };
+    Pos S1 = flip(s1), S2 = flip(s2), G1 = flip(g1), G2 = flip(g2), V = flip(Pos{conf.x, conf.y});
+
+    Pos Rs{std::max(S1.x, S2.x), std::max(S1.y, S2.y)};
+    Pos Re{std::min(G1.x, G2.x), std::min(G1.y, G2.y)};
+    if (Rs.x > Re.x || Rs.y > Re.y) return false;
+    if (V.x < Rs.x || V.x > Re.x || V.y < Rs.y || V.y > Re.y) return false;
+
+    // A 从下边进入矩形（x 已对齐，y 落后），B 从左边进入。其中一个可以就从矩形角出发
+    // （另一个仍从边外进入，两条最短路照样必然相交），这时两者时刻差非 0，只在 k-robust 下成立
+    auto fromBottom = [&](Pos s) { return s.x == Rs.x && s.y <= Rs.y; };
+    auto fromLeft   = [&](Pos s) { return s.y == Rs.y && s.x <= Rs.x; };
+    int A, B;
+    Pos SA, SB;
+    if (fromBottom(S1) && fromLeft(S2)) {
+        A = a1; B = a2; SA = S1; SB = S2;
+    } else if (fromBottom(S2) && fromLeft(S1)) {
+        A = a2; B = a1; SA = S2; SB = S1;
+    } else {
+        return false;
+    }
+    if (std::abs(manhattan(SA, Rs) - manhattan(SB, Rs)) > k) return false;
+
+    // A 不能按最短路时刻穿过上边 y = Re.y，B 不能按最短路时刻穿过右边 x = Re.x
+    Pos a1p = flip(Pos{Rs.x, Re.y}), a2p = flip(Pos{Re.x, Re.y});
+    Pos b1p = flip(Pos{Re.x, Rs.y}), b2p = flip(Pos{Re.x, Re.y});
+    Constraint cA{A, ConstraintType::Barrier, Re.y - SA.y, a1p.x, a1p.y, a2p.x, a2p.y};
+    Constraint cB{B, ConstraintType::Barrier, Re.x - SB.x, b1p.x, b1p.y, b2p.x, b2p.y};
+
+    if (!pathViolates(paths[A], cA) || !pathViolates(paths[B], cB)) return false;
+    out[0] = cA;
+    out[1] = cB;
+    return true;
+}
+
+// BFS 最短距离；blocked 中的格子不可走，不可达返回 INT_MAX
+static int bfsDistance(const Grid& grid, Pos from, Pos to, const std::vector<char>* blocked) {
+    if (from == to) return 0;
+    std::vector<int> dist(grid.W * grid.H, -1);
+    std::deque<Pos> q{from};
+    dist[from.y * grid.W + from.x] = 0;
+    const int dx[4] = {1,-1,0,0};
+    const int dy[4] = {0,0,1,-1};
+    while (!q.empty()) {
+        Pos c = q.front(); q.pop_front();
+        int d = dist[c.y * grid.W + c.x];
+        for (int k = 0; k < 4; k++) {
+            int nx = c.x + dx[k], ny = c.y + dy[k];
+            if (!grid.passable(nx, ny)) continue;
+            int id = ny * grid.W + nx;
+            if (dist[id] >= 0 || (blocked && (*blocked)[id])) continue;
+            dist[id] = d + 1;
+            if (nx == to.x && ny == to.y) return d + 1;
+            q.push_back(Pos{nx, ny});
+        }
+    }
+    return INT_MAX;
+}
+
+bool corridorConstraints(const Grid& grid,
+                         const std::vector<Pos>& starts,
+                         const std::vector<Path>& paths,
+                         const Conflict& conf,
+                         Constraint out[2]) {
+    if (!conf.exists) return false;
+
+    // 冲突处度数为 2 的格子，以及两个 agent 各自在那里的时刻
+    Pos c0;
+    int ta, tb;
+    if (!conf.isEdge) {
+        c0 = Pos{conf.x, conf.y};
+        ta = tb = conf.t;
+        if (degree(grid, c0) != 2) return false;
+    } else if (degree(grid, Pos{conf.ax1, conf.ay1}) == 2) {
+        c0 = Pos{conf.ax1, conf.ay1};
+        ta = conf.t; tb = conf.t + 1;
+    } else if (degree(grid, Pos{conf.ax2, conf.ay2}) == 2) {
+        c0 = Pos{conf.ax2, conf.ay2};
+        ta = conf.t + 1; tb = conf.t;
+    } else {
+        return false;
+    }
+
+    // 沿两个方向延伸到度数不为 2 的端点
+    std::vector<char> interior(grid.W * grid.H, 0);
+    interior[c0.y * grid.W + c0.x] = 1;
+    int interiorLen = 1;
+    Pos ends[2];
+    const int dx[4] = {1,-1,0,0};
+    const int dy[4] = {0,0,1,-1};
+    int side = 0;
+    for (int k = 0; k < 4; k++) {
+        Pos prev = c0, cur{c0.x + dx[k], c0.y + dy[k]};
+        if (!grid.passable(cur.x, cur.y)) continue;
+        while (degree(grid, cur) == 2) {
+            if (cur == c0) return false;   // 环形走廊
+            interior[cur.y * grid.W + cur.x] = 1;
+            interiorLen++;
+            Pos next = cur;
+            for (int d = 0; d < 4; d++) {
+                Pos nb{cur.x + dx[d], cur.y + dy[d]};
+                if (grid.passable(nb.x, nb.y) && !(nb == prev)) { next = nb; break; }
+            }
+            prev = cur;
+            cur = next;
+        }
+        ends[side++] = cur;
+    }
+    if (side != 2) return false;
+
+    for (int ag : {conf.a, conf.b})
+        if (interior[starts[ag].y * grid.W + starts[ag].x]) return false;
+
+    // 从冲突时刻往前找最近一次所在的端点（入口），往后找下一次所在的端点（出口）
+    auto traversal = [&](int ag, int tc, Pos& entry, Pos& exit) {
+        const Path& p = paths[ag];
+        bool hasEntry = false, hasExit = false;
+        for (int t = tc - 1; t >= 0 && !hasEntry; t--) {
+            Pos q = posAt(p, t);
+            if (q == ends[0] || q == ends[1]) { entry = q; hasEntry = true; }
+        }
+        for (int t = tc + 1; t < (int)p.size() && !hasExit; t++) {
+            Pos q = posAt(p, t);
+            if (q == ends[0] || q == ends[1]) { exit = q; hasExit = true; }
+        }
+        return hasEntry && hasExit && !(entry == exit);
+    };
+    Pos inA, outA, inB, outB;
+    if (!traversal(conf.a, ta, inA, outA) || !traversal(conf.b, tb, inB, outB)) return false;
+    if (!(inA == outB) || !(outA == inB)) return false;
+
+    // a 从 P0=inA 走到 Pk=outA，b 反向。若 b 先走完，a 到达 Pk 不早于 dist(s_b,Pk) + 2k；
+    // 若 a 不经过走廊（绕行）到达 Pk，不早于绕行距离
+    int k = interiorLen + 1;
+    const Pos sA = starts[conf.a], sB = starts[conf.b];
+    long long endA = std::min<long long>((long long)bfsDistance(grid, sB, outA, nullptr) + 2 * k - 1,
+                                         (long long)bfsDistance(grid, sA, outA, &interior) - 1);
+    long long endB = std::min<long long>((long long)bfsDistance(grid, sA, outB, nullptr) + 2 * k - 1,
+                                         (long long)bfsDistance(grid, sB, outB, &interior) - 1);
+    if (endA < 0 || endB < 0) return false;
+
+    Constraint cA{conf.a, ConstraintType::Range, 0, outA.x, outA.y, 0, 0, (int)endA};
+    Constraint cB{conf.b, ConstraintType::Range, 0, outB.x, outB.y, 0, 0, (int)endB};
+    if (!pathViolates(paths[conf.a], cA) || !pathViolates(paths[conf.b], cB)) return false;
+    out[0] = cA;
+    out[1] = cB;
+    return true;
+}
+
+} // namespace mapf
@@ -0,0 +1,85 @@
+#include "mapf/thread_slots.h"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <algorithm>
+
+namespace mapf {
+
+namespace {
+
+std::atomic<uint64_t> nextOwnerId{1};
+
+// 存活的 owner：编号 -> 对象。用编号而不是地址匹配，避免已析构 owner 的地址被复用后拿到悬空槽位。
+// 线程退出时的 release 和 owner 析构都持有这把锁，所以 release 不会碰到正在析构的 owner。
+// 故意不析构：主线程的 thread_local 表可能在静态对象析构之后才清理
+struct Owners {
+    std::mutex mu;
+    std::unordered_map<uint64_t, ThreadSlots*> live;
+};
+Owners& owners() {
+    static Owners* o = new Owners();
+    return *o;
+}
+
+} // namespace
+
+// 这个线程在各个 owner 里的槽位
+struct ThreadSlotTable {
+    struct Entry {
+        uint64_t owner;
+        void* slot;
+    };
+    std::vector<Entry> entries;
+
+    ~ThreadSlotTable() {
+        Owners& o = owners();
+        std::lock_guard<std::mutex> lock(o.mu);
+        for (const auto& e : entries) {
+            auto it = o.live.find(e.owner);
+            if (it != o.live.end()) it->second->release_(e.slot);
+        }
+    }
+};
+
+namespace {
+thread_local ThreadSlotTable tlsSlots;
+}
+
+ThreadSlots::ThreadSlots(std::function<void*()> acquire, std::function<void(void*)> release)
+    : id_(nextOwnerId.fetch_add(1)), acquire_(std::move(acquire)), release_(std::move(release)) {
+    Owners& o = owners();
+    std::lock_guard<std::mutex> lock(o.mu);
+    o.live[id_] = this;
+}
+
+ThreadSlots::~ThreadSlots() {
+    Owners& o = owners();
+    std::lock_guard<std::mutex> lock(o.mu);
+    o.live.erase(id_);
+}
+
+void* ThreadSlots::local() {
+    for (const auto& e : tlsSlots.entries)
+        if (e.owner == id_) return e.slot;
+    return attach();
+}
+
+void* ThreadSlots::attach() {
+    auto& entries = tlsSlots.entries;
+    {
+        // 顺便清掉已析构 owner 的表项，长期运行的线程见过再多 owner 表也不变长
+        Owners& o = owners();
+        std::lock_guard<std::mutex> lock(o.mu);
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [&](const ThreadSlotTable::Entry& e) { return !o.live.count(e.owner); }),
+                      entries.end());
+    }
+    void* s = acquire_();
+    entries.push_back(ThreadSlotTable::Entry{id_, s});
+    return s;
+}
+
+} // namespace mapf
@@ -0,0 +1,164 @@
+#include "mapf/trace.h"
+
+#include <ostream>
+#include <cstdio>
+#include <algorithm>
+#include <type_traits>
+
+namespace mapf {
+
+struct Tracer::Ring {
+    Ring(size_t cap, uint16_t tid) : slots(cap), mask(cap - 1), tid(tid) {}
+
+    std::vector<TraceEvent> slots;
+    size_t mask;
+    uint16_t tid;
+    std::atomic<uint64_t> head{0};   // 只由当前持有这个缓冲的线程写
+};
+
+namespace {
+
+const char* eventName(TraceEventType t) {
+    switch (t) {
+        case TraceEventType::CTPop:     return "ct_pop";
+        case TraceEventType::CTSplit:   return "ct_split";
+        case TraceEventType::LowLevel:  return "low_level";
+        case TraceEventType::CacheHit:  return "cache_hit";
+        case TraceEventType::CacheMiss: return "cache_miss";
+        default:                        return "solve";
+    }
+}
+
+const char* splitName(uint8_t d) {
+    static const char* names[4] = {"vertex", "edge", "rectangle", "corridor"};
+    return names[d & 3];
+}
+
+template <class T>
+void put(std::ostream& out, T v) {
+    auto u = static_cast<typename std::make_unsigned<T>::type>(v);
+    char b[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); i++) b[i] = char((u >> (8 * i)) & 0xff);
+    out.write(b, sizeof(T));
+}
+
+} // namespace
+
+Tracer::Tracer(size_t capacityPerThread)
+    : capacity_(1), t0_(std::chrono::steady_clock::now()),
+      slots_([this]() -> void* {
+                 std::lock_guard<std::mutex> lock(mu_);
+                 if (!free_.empty()) {
+                     Ring* r = free_.back();
+                     free_.pop_back();
+                     return r;
+                 }
+                 uint16_t tid = (uint16_t)std::min<size_t>(rings_.size(), UINT16_MAX);
+                 rings_.emplace_back(new Ring(capacity_, tid));
+                 return rings_.back().get();
+             },
+             [this](void* r) {
+                 std::lock_guard<std::mutex> lock(mu_);
+                 free_.push_back(static_cast<Ring*>(r));
+             }) {
+    while (capacity_ < capacityPerThread) capacity_ <<= 1;
+}
+
+Tracer::~Tracer() = default;
+
+void Tracer::record(TraceEvent ev) {
+    Ring* r = static_cast<Ring*>(slots_.local());
+    uint64_t h = r->head.load(std::memory_order_relaxed);
+    ev.tid = r->tid;
+    r->slots[h & r->mask] = ev;
+    r->head.store(h + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> Tracer::snapshot() const {
+    std::vector<TraceEvent> out;
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& r : rings_) {
+        uint64_t h = r->head.load(std::memory_order_acquire);
+        uint64_t n = std::min<uint64_t>(h, r->slots.size());
+        for (uint64_t i = h - n; i < h; i++) out.push_back(r->slots[i & r->mask]);
+    }
+    std::stable_sort(out.begin(), out.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) { return a.ts < b.ts; });
+    return out;
+}
+
+uint64_t Tracer::dropped() const {
+    uint64_t d = 0;
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& r : rings_) {
+        uint64_t h = r->head.load(std::memory_order_acquire);
+        if (h > r->slots.size()) d += h - r->slots.size();
+    }
+    return d;
+}
+
+void Tracer::writeChromeJson(std::ostream& out) const {
+    std::vector<TraceEvent> evs = snapshot();
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    char ts[32];
+    for (const auto& e : evs) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        // Chrome trace 的时间单位是微秒
+        std::snprintf(ts, sizeof(ts), "%.3f", (double)e.ts / 1000.0);
+        out << "{\"name\":\"" << eventName(e.type) << "\",\"pid\":1,\"tid\":" << e.tid
+            << ",\"ts\":" << ts;
+        if (e.type == TraceEventType::LowLevel || e.type == TraceEventType::Solve) {
+            std::snprintf(ts, sizeof(ts), "%.3f", (double)e.dur / 1000.0);
+            out << ",\"ph\":\"X\",\"dur\":" << ts;
+        } else {
+            out << ",\"ph\":\"i\",\"s\":\"t\"";
+        }
+        out << ",\"args\":{";
+        switch (e.type) {
+            case TraceEventType::CTPop:
+                out << "\"node\":" << e.node << ",\"cost\":" << e.arg << ",\"constraints\":" << e.value;
+                break;
+            case TraceEventType::CTSplit:
+                out << "\"node\":" << e.node << ",\"conflict\":\"" << splitName(e.detail) << '"'
+                    << ",\"disjoint\":" << ((e.detail & kSplitDisjoint) ? "true" : "false")
+                    << ",\"a\":" << e.agent << ",\"b\":" << e.value << ",\"t\":" << e.arg;
+                break;
+            case TraceEventType::LowLevel:
+                out << "\"node\":" << e.node << ",\"agent\":" << e.agent << ",\"maxT\":" << e.arg
+                    << ",\"expansions\":" << e.value
+                    << ",\"found\":" << ((e.detail & 1) ? "true" : "false")
+                    << ",\"incremental\":" << ((e.detail & 2) ? "true" : "false");
+                break;
+            case TraceEventType::CacheHit:
+            case TraceEventType::CacheMiss:
+                out << "\"node\":" << e.node << ",\"agent\":" << e.agent << ",\"maxT\":" << e.arg;
+                break;
+            default:
+                out << "\"status\":" << (int)e.detail << ",\"cost\":" << e.arg << ",\"expanded\":" << e.value;
+                break;
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+}
+
+void Tracer::writeBinary(std::ostream& out) const {
+    std::vector<TraceEvent> evs = snapshot();
+    out.write("MAPFTRC1", 8);
+    put<uint64_t>(out, evs.size());
+    for (const auto& e : evs) {
+        put<uint64_t>(out, e.ts);
+        put<uint32_t>(out, e.dur);
+        put<uint8_t>(out, (uint8_t)e.type);
+        put<uint8_t>(out, e.detail);
+        put<uint16_t>(out, e.tid);
+        put<int32_t>(out, e.node);
+        put<int32_t>(out, e.agent);
+        put<int32_t>(out, e.arg);
+        put<int64_t>(out, e.value);
+    }
+}
+
+} // namespace mapf
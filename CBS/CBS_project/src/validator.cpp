@@ -0,0 +1,193 @@
+#include "mapf/validator.h"
+
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+
+namespace mapf {
+
+namespace {
+
+// 一个线程负责 [t0, t1) 的时刻（以及从这些时刻出发的移动）；只写自己的计数，
+// perTimestep 的切片互不重叠
+struct SliceResult {
+    long long vertex = 0, swap = 0, crossing = 0, obstacle = 0, jump = 0;
+    std::vector<int> perAgent;
+    std::vector<Violation> samples;
+};
+
+// 当前时刻被占的格子 -> 格子上的 agent 链表。按格子编号做开放寻址哈希（容量是 agent 数两倍以上的 2 的幂），
+// 大小只和 agent 数有关、与地图面积无关；stamp 标记槽位属于哪个时刻，旧时刻的槽位当空位用，换时刻不用清空
+struct Occupancy {
+    std::vector<size_t> key;
+    std::vector<int> stamp, head, next;
+    int shift = 64;
+
+    explicit Occupancy(size_t agents) : next(agents, -1) {
+        size_t cap = 16;
+        while (cap < 2 * agents) cap <<= 1;
+        for (size_t c = cap; c > 1; c >>= 1) shift--;
+        key.assign(cap, 0);
+        stamp.assign(cap, -1);
+        head.assign(cap, -1);
+    }
+
+    size_t slotOf(size_t cell, int t) const {
+        size_t mask = key.size() - 1;
+        size_t h = (size_t)(((uint64_t)cell * 0x9e3779b97f4a7c15ull) >> shift);
+        while (stamp[h] == t && key[h] != cell) h = (h + 1) & mask;
+        return h;
+    }
+    int first(size_t cell, int t) const {
+        size_t h = slotOf(cell, t);
+        return stamp[h] == t ? head[h] : -1;
+    }
+    void add(size_t cell, int t, int agent) {
+        size_t h = slotOf(cell, t);
+        if (stamp[h] != t) { stamp[h] = t; key[h] = cell; head[h] = -1; }
+        next[agent] = head[h];
+        head[h] = agent;
+    }
+};
+
+void checkSlice(const Grid& grid, const std::vector<Path>& paths, const ValidationOptions& opt,
+                int t0, int t1, std::vector<int>& perTimestep, SliceResult& res) {
+    const int n = (int)paths.size();
+    const bool diagonal = isEightConnected(opt.motion);
+    const size_t W = (size_t)grid.W;
+    res.perAgent.assign(n, 0);
+
+    // 两份占用表交替表示 t-1 和 t；地图外的位置不进表（已按障碍计）
+    Occupancy occ[2] = {Occupancy(n), Occupancy(n)};
+    auto pos = [&](int i, int t) {
+        const Path& p = paths[i];
+        return t < (int)p.size() ? p[t] : p.back();
+    };
+    auto cellOf = [&](const Pos& p) { return (size_t)p.y * W + (size_t)p.x; };
+    auto report = [&](ViolationKind kind, int t, int a, int b, Pos p) {
+        res.perAgent[a]++;
+        if (b >= 0) res.perAgent[b]++;
+        perTimestep[t]++;
+        if (res.samples.size() < opt.maxSamples) res.samples.push_back(Violation{kind, t, a, b, p});
+    };
+
+    // 顶点检查覆盖 [t0, t1)，移动检查覆盖从 [t0, t1) 出发的步，所以还要建 t1 的占用表
+    int end = std::min(t1 + 1, (int)perTimestep.size());
+    for (int t = t0; t < end; t++) {
+        Occupancy& cur = occ[t & 1];
+        const Occupancy& prev = occ[(t - 1) & 1];
+        const bool counted = t < t1;
+
+        for (int i = 0; i < n; i++) {
+            if (paths[i].empty()) continue;
+            Pos p = pos(i, t);
+            if (!grid.inBounds(p.x, p.y)) {
+                if (counted) { res.obstacle++; report(ViolationKind::Obstacle, t, i, -1, p); }
+                continue;
+            }
+            size_t c = cellOf(p);
+            if (counted) {
+                if (!grid.passable(p.x, p.y)) { res.obstacle++; report(ViolationKind::Obstacle, t, i, -1, p); }
+                for (int j = cur.first(c, t); j >= 0; j = cur.next[j]) {
+                    res.vertex++;
+                    report(ViolationKind::Vertex, t, std::min(i, j), std::max(i, j), p);
+                }
+            }
+            cur.add(c, t, i);
+        }
+        if (t == t0) continue;
+
+        // t-1 -> t 这一步：非法位移、对穿、斜向交叉
+        for (int i = 0; i < n; i++) {
+            if (paths[i].empty()) continue;
+            Pos u = pos(i, t - 1), v = pos(i, t);
+            if (u == v) continue;
+            int ax = std::abs(v.x - u.x), ay = std::abs(v.y - u.y);
+            bool ok = diagonal ? std::max(ax, ay) <= 1 : ax + ay <= 1;
+            if (ok && diagonal && ax && ay)
+                ok = grid.passable(v.x, u.y) && grid.passable(u.x, v.y);   // 不能切角
+            if (!ok) { res.jump++; report(ViolationKind::Jump, t - 1, i, -1, u); }
+            if (!grid.inBounds(u.x, u.y) || !grid.inBounds(v.x, v.y)) continue;
+
+            // 每对只在编号小的一方处理，避免重复计数
+            for (int j = prev.first(cellOf(v), t - 1); j >= 0; j = prev.next[j]) {
+                if (j > i && pos(j, t) == u) { res.swap++; report(ViolationKind::Swap, t - 1, i, j, u); }
+            }
+            if (diagonal && ax == 1 && ay == 1) {
+                Pos c1{u.x, v.y}, c2{v.x, u.y};
+                for (int j = prev.first(cellOf(c1), t - 1); j >= 0; j = prev.next[j]) {
+                    if (j > i && pos(j, t) == c2) { res.crossing++; report(ViolationKind::Crossing, t - 1, i, j, u); }
+                }
+                for (int j = prev.first(cellOf(c2), t - 1); j >= 0; j = prev.next[j]) {
+                    if (j > i && pos(j, t) == c1) { res.crossing++; report(ViolationKind::Crossing, t - 1, i, j, u); }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+ValidationReport validatePlan(const Grid& grid,
+                              const std::vector<Path>& paths,
+                              const ValidationOptions& opt) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+
+    ValidationReport rep;
+    const int n = (int)paths.size();
+    int T = 0;
+    for (const auto& p : paths) T = std::max(T, (int)p.size());
+    rep.perAgent.assign(n, 0);
+    rep.perTimestep.assign(std::max(T, 1), 0);
+
+    // 起终点和空路径在主线程检查
+    for (int i = 0; i < n; i++) {
+        const Path& p = paths[i];
+        bool badStart = !p.empty() && opt.starts && i < (int)opt.starts->size() && !(p.front() == (*opt.starts)[i]);
+        bool badGoal  = !p.empty() && opt.goals && i < (int)opt.goals->size() && !(p.back() == (*opt.goals)[i]);
+        if (!p.empty() && !badStart && !badGoal) continue;
+        int t = badStart || p.empty() ? 0 : (int)p.size() - 1;
+        rep.endpoint++;
+        rep.perAgent[i]++;
+        rep.perTimestep[t]++;
+        if (rep.samples.size() < opt.maxSamples)
+            rep.samples.push_back(Violation{ViolationKind::Endpoint, t, i, -1, p.empty() ? Pos{} : p[t]});
+    }
+
+    int threads = opt.threads > 0 ? opt.threads : std::max(1, (int)std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, T / 64 + 1));   // 每片至少几十个时刻，否则线程开销不划算
+    std::vector<SliceResult> res(threads);
+    auto sliceBegin = [&](int k) { return (int)((long long)T * k / threads); };
+
+    if (threads == 1) {
+        checkSlice(grid, paths, opt, 0, T, rep.perTimestep, res[0]);
+    } else {
+        std::vector<std::thread> pool;
+        for (int k = 0; k < threads; k++)
+            pool.emplace_back(checkSlice, std::cref(grid), std::cref(paths), std::cref(opt),
+                              sliceBegin(k), sliceBegin(k + 1), std::ref(rep.perTimestep), std::ref(res[k]));
+        for (auto& th : pool) th.join();
+    }
+
+    for (const auto& r : res) {
+        rep.vertex += r.vertex;
+        rep.swap += r.swap;
+        rep.crossing += r.crossing;
+        rep.obstacle += r.obstacle;
+        rep.jump += r.jump;
+        for (int i = 0; i < n; i++) rep.perAgent[i] += r.perAgent[i];
+        rep.samples.insert(rep.samples.end(), r.samples.begin(), r.samples.end());
+    }
+    std::stable_sort(rep.samples.begin(), rep.samples.end(),
+                     [](const Violation& a, const Violation& b) { return a.t < b.t; });
+    if (rep.samples.size() > opt.maxSamples) rep.samples.resize(opt.maxSamples);
+
+    rep.valid = rep.total() == 0;
+    rep.runtimeMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    return rep;
+}
+
+} // namespace mapf
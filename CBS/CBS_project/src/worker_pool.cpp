@@ -0,0 +1,57 @@
+#include "mapf/worker_pool.h"
+
+namespace mapf {
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& th : threads_) th.join();
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mu_);
+    tasks_.push_back(std::move(task));
+    if (idle_ < (int)tasks_.size() && (maxThreads_ <= 0 || (int)threads_.size() < maxThreads_))
+        threads_.emplace_back([this]() { loop(); });
+    else cv_.notify_one();
+}
+
+void WorkerPool::runAll(int n, const std::function<void(int)>& fn) {
+    std::mutex doneMu;
+    std::condition_variable doneCv;
+    int pending = n - 1;
+    for (int i = 1; i < n; i++)
+        submit([&, i]() {
+            fn(i);
+            std::lock_guard<std::mutex> lock(doneMu);
+            if (--pending == 0) doneCv.notify_all();
+        });
+    if (n > 0) fn(0);
+    std::unique_lock<std::mutex> lock(doneMu);
+    doneCv.wait(lock, [&]() { return pending <= 0; });
+}
+
+WorkerPool& WorkerPool::shared() {
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::loop() {
+    std::unique_lock<std::mutex> lock(mu_);
+    for (;;) {
+        idle_++;
+        cv_.wait(lock, [&]() { return stop_ || !tasks_.empty(); });
+        idle_--;
+        if (tasks_.empty()) return;
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+} // namespace mapf
@@ -0,0 +1,66 @@
+#pragma once
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "mapf/mapf.h"
+
+// 回归语料：data/corpus.txt 是批处理格式的实例（地图路径相对 data 目录），
+// data/expected.txt 是每个实例的最优代价和默认模式下的计数基线
+namespace mapf_test {
+
+struct CorpusEntry {
+    mapf::Instance inst;
+    std::shared_ptr<const mapf::Grid> grid;
+};
+
+struct Expected {
+    int soc = -1;                 // 4 连通最优代价
+    int soc8 = -1;                // 8 连通最优代价
+    long long ct = 0, llexp = 0;              // 默认选项下的 CT 扩展数、低层扩展数
+    long long ctFast = 0, llexpFast = 0;      // disjoint + symmetry + incremental 下的同样计数
+};
+
+inline bool loadCorpus(const std::string& dataDir, std::vector<CorpusEntry>& out,
+                       mapf::MapCache& maps, std::string* err) {
+    std::ifstream in(dataDir + "/corpus.txt");
+    if (!in) { *err = "cannot open " + dataDir + "/corpus.txt"; return false; }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        CorpusEntry e;
+        if (!mapf::parseInstance(line, e.inst, err)) return false;
+        e.inst.map = dataDir + "/" + e.inst.map;
+        e.grid = maps.get(e.inst.map, err);
+        if (!e.grid) return false;
+        out.push_back(std::move(e));
+    }
+    return true;
+}
+
+// expected.txt：每行 id soc soc8 ct llexp ctFast llexpFast，'#' 开头为注释
+inline std::map<std::string, Expected> loadExpected(const std::string& path) {
+    std::map<std::string, Expected> m;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        std::string id;
+        Expected e;
+        if (ls >> id >> e.soc >> e.soc8 >> e.ct >> e.llexp >> e.ctFast >> e.llexpFast) m[id] = e;
+    }
+    return m;
+}
+
+inline mapf::CBSOptions fastOptions() {
+    mapf::CBSOptions o;
+    o.disjointSplitting = true;
+    o.symmetryReasoning = true;
+    o.incrementalLowLevel = true;
+    return o;
+}
+
+} // namespace mapf_test
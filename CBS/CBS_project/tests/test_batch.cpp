@@ -0,0 +1,79 @@
+#include "test_util.h"
+#include "mapf/mapf.h"
+#include "mapf/worker_pool.h"
+
+#include <thread>
+#include <sstream>
+#include <fstream>
+#include <set>
+#include <cstdio>
+
+using namespace mapf;
+
+static std::string writeMap() {
+    std::string path = "test_batch.map";
+    std::ofstream f(path);
+    for (int y = 0; y < 8; y++) f << (y == 3 ? "...##..." : "........") << "\n";
+    return path;
+}
+
+// 一条流：k 个实例，两个 agent 在同一行对穿
+static std::string stream(const std::string& map, int s, int k) {
+    std::ostringstream ss;
+    for (int i = 0; i < k; i++) {
+        int y = (s + i) % 8 == 3 ? 4 : (s + i) % 8;
+        ss << "s" << s << "-" << i << ' ' << map << " 2 0 " << y << " 7 " << y << " 7 " << y << " 0 " << y << "\n";
+    }
+    return ss.str();
+}
+
+// 多条流共用一个有上限的求解池：解全部写回各自的流，求解只发生在池里的线程上
+static void testSharedPool(bool portfolio) {
+    std::string map = writeMap();
+    Tracer tr(1 << 12);
+    BatchOptions opt;
+    opt.threads = 2;
+    opt.writePaths = false;
+    opt.portfolio = portfolio;
+    opt.portfolioThreads = 1;
+    opt.cbs.tracer = &tr;
+    MapCache maps;
+    WorkerPool solvers(opt.threads);
+
+    const int streams = 4, per = 6;
+    std::vector<std::string> outs(streams);
+    std::vector<BatchSummary> sums(streams);
+    std::vector<std::thread> conns;
+    for (int s = 0; s < streams; s++)
+        conns.emplace_back([&, s]() {
+            std::istringstream in(stream(map, s, per));
+            std::ostringstream out;
+            sums[s] = runBatch(in, out, opt, maps, &solvers);
+            outs[s] = out.str();
+        });
+    for (auto& th : conns) th.join();
+
+    for (int s = 0; s < streams; s++) {
+        CHECK_EQ(sums[s].instances, per);
+        CHECK_EQ(sums[s].solved, per);
+        std::istringstream in(outs[s]);
+        std::string line;
+        int lines = 0;
+        while (std::getline(in, line)) {
+            lines++;
+            CHECK(line.compare(0, 2, "s" + std::to_string(s)) == 0);
+            CHECK(line.find(" ok soc=") != std::string::npos);
+        }
+        CHECK_EQ(lines, per);
+    }
+    std::set<int> tids;
+    for (const auto& ev : tr.snapshot()) tids.insert(ev.tid);
+    CHECK(!tids.empty() && (int)tids.size() <= opt.threads);
+    std::remove(map.c_str());
+}
+
+int main() {
+    testSharedPool(false);
+    testSharedPool(true);
+    return mapf_test::testResult();
+}
@@ -0,0 +1,300 @@
+#include "test_util.h"
+#include "mapf/mapf.h"
+
+#include <atomic>
+
+using namespace mapf;
+using mapf_test::makeGrid;
+
+static bool valid(const Grid& grid, const std::vector<Pos>& starts, const std::vector<Pos>& goals,
+                  const std::vector<Path>& paths, MotionModel motion = MotionModel::FourConnected) {
+    ValidationOptions vo;
+    vo.motion = motion;
+    vo.starts = &starts;
+    vo.goals = &goals;
+    return paths.size() == starts.size() && validatePlan(grid, paths, vo).valid;
+}
+
+// main.cpp 里的演示实例
+static void testDemo() {
+    Grid grid = makeGrid({
+        "..........",
+        ".####.....",
+        "..........",
+        ".....####.",
+        ".........."
+    });
+    std::vector<Pos> starts = {{0, 0}, {0, 4}};
+    std::vector<Pos> goals  = {{9, 4}, {2, 4}};
+    std::vector<Path> sol;
+    CHECK(CBS(grid, starts, goals, sol));
+    CHECK_EQ(sumOfCosts(sol), 15);
+    CHECK(valid(grid, starts, goals, sol));
+}
+
+// 代价 = 到达终点前的步数（途中等待算，到达后原地等待不算），不是 n * 补齐后的长度
+static void testSumOfCosts() {
+    Path p = {{0, 0}, {1, 0}, {1, 0}, {2, 0}, {2, 0}, {2, 0}};
+    CHECK_EQ(pathCost(p), 3);
+    std::vector<Path> paths = {p, {{5, 5}}, {{4, 0}, {4, 1}}};
+    CHECK_EQ(sumOfCosts(paths), 4);
+    padPathsToSameLength(paths);
+    CHECK_EQ(sumOfCosts(paths), 4);
+
+    // 互不干扰的一长一短两条路：CBS 返回的路径按搜索上界补齐，代价和仍是 1 + 4
+    Grid grid = makeGrid({".........."});
+    std::vector<Pos> starts = {{0, 0}, {5, 0}}, goals = {{1, 0}, {9, 0}};
+    std::vector<Path> sol;
+    CHECK(CBS(grid, starts, goals, sol));
+    CHECK_EQ(sumOfCosts(sol), 5);
+    CHECK_EQ(pathCost(sol[0]), 1);
+    CHECK_EQ(pathCost(sol[1]), 4);
+}
+
+// 6 个 agent 在 8x8 空地上两两对穿，必然有冲突
+static void crossing(Grid& grid, std::vector<Pos>& starts, std::vector<Pos>& goals) {
+    grid = makeGrid(std::vector<std::string>(8, std::string(8, '.')));
+    grid.g[3][3] = grid.g[4][4] = '#';
+    starts = {{0, 3}, {7, 3}, {3, 0}, {3, 7}, {0, 0}, {7, 7}};
+    goals  = {{7, 3}, {0, 3}, {3, 7}, {3, 0}, {7, 7}, {0, 0}};
+}
+
+static void testModesAgree() {
+    Grid grid;
+    std::vector<Pos> starts, goals;
+    crossing(grid, starts, goals);
+
+    std::vector<Path> ref;
+    CBSStats rs;
+    CHECK(CBS(grid, starts, goals, ref, CBSOptions{}, &rs));
+    CHECK(valid(grid, starts, goals, ref));
+    CHECK(rs.ctExpanded > 1);
+    int opt = sumOfCosts(ref);
+
+    std::vector<CBSOptions> modes(9);
+    modes[0].disjointSplitting = true;
+    modes[1].symmetryReasoning = true;
+    modes[2].incrementalLowLevel = true;
+    modes[3].lowLevelCacheCapacity = 256;
+    modes[4].pruneDuplicateNodes = true;
+    modes[5].conflictSelection = ConflictSelection::MostInvolved;
+    modes[6].conflictSelection = ConflictSelection::Random;
+    modes[6].seed = 7;
+    modes[7].memoryBudgetBytes = 4096;
+    modes[8].disjointSplitting = modes[8].symmetryReasoning = modes[8].incrementalLowLevel = true;
+    for (const auto& o : modes) {
+        std::vector<Path> sol;
+        CHECK(CBS(grid, starts, goals, sol, o));
+        CHECK_EQ(sumOfCosts(sol), opt);
+        CHECK(valid(grid, starts, goals, sol));
+    }
+
+    CBSOptions b;
+    b.suboptimality = 1.5;
+    std::vector<Path> sol;
+    CHECK(CBS(grid, starts, goals, sol, b));
+    CHECK(sumOfCosts(sol) <= 1.5 * opt);
+    CHECK(valid(grid, starts, goals, sol));
+}
+
+static void testEightConnected() {
+    Grid grid;
+    std::vector<Pos> starts, goals;
+    crossing(grid, starts, goals);
+    CBSOptions o;
+    o.motion = MotionModel::EightConnected;
+    std::vector<Path> sol;
+    CHECK(CBS(grid, starts, goals, sol, o));
+    CHECK(valid(grid, starts, goals, sol, MotionModel::EightConnected));
+}
+
+// 等待代价不同的 8 连通模型：让路时等待便宜就原地等，否则斜着绕开
+static void testWaitCost() {
+    std::vector<Pos> starts = {{0, 1}, {1, 0}}, goals = {{2, 1}, {1, 2}};
+    auto solve = [&](const Grid& grid, MotionModel m, std::vector<Path>& sol) {
+        CBSOptions o;
+        o.motion = m;
+        CHECK(CBS(grid, starts, goals, sol, o));
+        CHECK(valid(grid, starts, goals, sol, m));
+        return sumOfCosts(sol, m);
+    };
+    std::vector<Path> sol;
+    Grid open = makeGrid({"...", "...", "..."});
+    CHECK_EQ(solve(open, MotionModel::EightConnected, sol), 14 + 14 + 20);
+    CHECK_EQ(sumOfCosts(sol), 4);
+    CHECK_EQ(solve(open, MotionModel::EightConnectedCheapWait, sol), 5 + 20 + 20);
+    CHECK_EQ(sumOfCosts(sol), 5);
+    CHECK_EQ(solve(open, MotionModel::EightConnectedCostlyWait, sol), 14 + 14 + 20);
+
+    // 十字路口没法绕，必须有人等一步
+    Grid cross = makeGrid({"#.#", "...", "#.#"});
+    CHECK_EQ(solve(cross, MotionModel::EightConnected, sol), 10 + 40);
+    CHECK_EQ(solve(cross, MotionModel::EightConnectedCheapWait, sol), 5 + 40);
+    CHECK_EQ(solve(cross, MotionModel::EightConnectedCostlyWait, sol), 20 + 40);
+
+    MotionModel m;
+    CHECK(parseMotionModel("eight-cheap-wait", m) && m == MotionModel::EightConnectedCheapWait);
+    CHECK(!parseMotionModel("nine", m));
+}
+
+static void testWarmStart() {
+    Grid grid;
+    std::vector<Pos> starts, goals;
+    crossing(grid, starts, goals);
+    std::vector<Path> sol;
+    CHECK(CBS(grid, starts, goals, sol));
+
+    // 原样喂回：全部沿用，根节点就是解
+    CBSOptions o;
+    o.initialPaths = &sol;
+    std::vector<Path> again;
+    CBSStats st;
+    CHECK(CBS(grid, starts, goals, again, o, &st));
+    CHECK_EQ(st.warmStartReused, (int)starts.size());
+    CHECK_EQ(st.ctExpanded, 1);
+    CHECK_EQ(sumOfCosts(again), sumOfCosts(sol));
+
+    // 改一个终点：只重规划这个 agent
+    goals[0] = Pos{6, 6};
+    CHECK(CBS(grid, starts, goals, again, o, &st));
+    CHECK_EQ(st.warmStartReused, (int)starts.size() - 1);
+    CHECK(valid(grid, starts, goals, again));
+}
+
+static void testCancel() {
+    Grid grid;
+    std::vector<Pos> starts, goals;
+    crossing(grid, starts, goals);
+    std::atomic<bool> cancel{true};
+    CBSOptions o;
+    o.cancel = &cancel;
+    std::vector<Path> sol;
+    CBSStats st;
+    CHECK(!CBS(grid, starts, goals, sol, o, &st));
+    CHECK(st.cancelled);
+}
+
+// 配置比线程多时排队跑，不丢配置：无解实例上每个配置都轮到一次（各自超时）
+static void testPortfolioQueue() {
+    Grid grid = makeGrid({".."});
+    std::vector<Pos> starts = {{0, 0}, {1, 0}}, goals = {{1, 0}, {0, 0}};
+    PortfolioOptions po;
+    po.variants = defaultPortfolio(1.0);
+    po.variants.resize(3);
+    for (auto& v : po.variants) v.cbs.timeLimitMs = 30;
+    po.maxThreads = 1;
+    std::vector<Path> sol;
+    PortfolioStats ps;
+    CHECK(!portfolioCBS(grid, starts, goals, sol, po, &ps));
+    CHECK_EQ((int)ps.names.size(), 3);
+    for (const auto& st : ps.variantStats) CHECK(st.lowLevelCalls > 0);
+
+    // 有解时有配置胜出，后面排队的不再启动。时间上限放宽，机器繁忙时结果也不变
+    for (auto& v : po.variants) v.cbs.timeLimitMs = 10000;
+    Grid open;
+    crossing(open, starts, goals);
+    CHECK(portfolioCBS(open, starts, goals, sol, po, &ps));
+    CHECK(ps.winner >= 0 && ps.winner < 2);
+    CHECK(valid(open, starts, goals, sol));
+    CHECK_EQ(ps.variantStats[2].lowLevelCalls, 0);
+}
+
+// k-robust：紧跟在别人后面算冲突；各种模式的代价一致，解里同一格子两次占用至少隔 k+1 步
+static void testRobust() {
+    std::vector<Path> follow = {{{0, 0}, {1, 0}, {2, 0}}, {{0, 1}, {0, 0}, {1, 0}}};
+    CHECK(!detectFirstConflict<FourConnected>(follow).exists);
+    Conflict c = detectFirstConflict<FourConnected>(follow, 1);
+    CHECK(c.exists && !c.isEdge);
+    CHECK_EQ(c.a, 0);
+    CHECK_EQ(c.b, 1);
+    CHECK_EQ(c.t, 0);
+    CHECK_EQ(c.delay, 1);
+    CHECK(c.x == 0 && c.y == 0);
+    CHECK_EQ(detectAllConflicts<FourConnected>(follow, 1).size(), (size_t)1);
+
+    Grid grid;
+    std::vector<Pos> starts, goals;
+    crossing(grid, starts, goals);
+    std::vector<Path> plain;
+    CHECK(CBS(grid, starts, goals, plain));
+    for (int k = 1; k <= 2; k++) {
+        if (k == 2) {   // 6 个 agent 在 k = 2 下很难，只留前 4 个
+            starts.resize(4);
+            goals.resize(4);
+            plain.clear();
+            CHECK(CBS(grid, starts, goals, plain));
+        }
+        CBSOptions base;
+        base.robustness = k;
+        std::vector<Path> ref;
+        CHECK(CBS(grid, starts, goals, ref, base));
+        CHECK(valid(grid, starts, goals, ref));
+        CHECK(!detectFirstConflict<FourConnected>(ref, k).exists);
+        CHECK(sumOfCosts(ref) >= sumOfCosts(plain));
+
+        std::vector<CBSOptions> modes(5, base);
+        modes[0].incrementalLowLevel = true;
+        modes[1].symmetryReasoning = true;
+        modes[2].lowLevelCacheCapacity = 256;
+        modes[3].memoryBudgetBytes = 4096;
+        modes[4].disjointSplitting = true;   // k-robust 下忽略
+        for (const auto& o : modes) {
+            std::vector<Path> sol;
+            CHECK(CBS(grid, starts, goals, sol, o));
+            CHECK_EQ(sumOfCosts(sol), sumOfCosts(ref));
+            CHECK(!detectFirstConflict<FourConnected>(sol, k).exists);
+        }
+    }
+}
+
+// 按索引建表要和扫描整个约束列表建表一致，终点汇总要和逐时刻检查一致
+static void testConstraintIndex() {
+    std::vector<Pos> goals = {Pos{2, 2}, Pos{5, 1}, Pos{0, 4}};
+    std::vector<Constraint> cons = {
+        {0, ConstraintType::Vertex, 3, 2, 2, 0, 0},
+        {1, ConstraintType::Edge, 4, 5, 1, 5, 1},
+        {1, ConstraintType::PositiveVertex, 6, 4, 1, 0, 0},
+        {2, ConstraintType::Range, 2, 0, 4, 0, 0, 7},
+        {0, ConstraintType::Barrier, 1, 0, 2, 3, 2},
+        {2, ConstraintType::PositiveEdge, 8, 2, 2, 2, 3},
+        {0, ConstraintType::Edge, 9, 1, 1, 1, 2},
+    };
+    ConstraintIndex idx;
+    resetConstraintIndex(idx, 3);
+    for (int k = 0; k < (int)cons.size(); k++) indexConstraint(idx, cons, k, goals);
+    CHECK_EQ(idx.maxTimeAll, 9);
+    CHECK_EQ(idx.maxTime[0], 9);
+    CHECK_EQ(idx.maxTime[1], 6);
+    CHECK_EQ(idx.maxTime[2], 9);
+
+    const int H = 20;
+    for (int a = 0; a < 3; a++) {
+        ConstraintTable full = buildConstraintTable(cons, a);
+        ConstraintTable fast = buildConstraintTable(cons, idx, a, goals[a]);
+        CHECK(full.forbV == fast.forbV);
+        CHECK(full.forbE == fast.forbE);
+        CHECK(full.forbRange == fast.forbRange);
+        CHECK(full.mustV == fast.mustV);
+        const Pos& g = goals[a];
+        for (int t = 0; t <= H; t++) {
+            bool safe = true;
+            for (int tau = t; tau <= H && safe; tau++)
+                safe = !violatesVertex(full, g.x, g.y, tau) && (tau == H || !violatesEdge(full, g.x, g.y, g.x, g.y, tau));
+            CHECK_EQ(safe, fast.goalVertexLast < t && fast.goalWaitLast < t);
+        }
+    }
+}
+
+int main() {
+    testDemo();
+    testSumOfCosts();
+    testModesAgree();
+    testEightConnected();
+    testWaitCost();
+    testWarmStart();
+    testCancel();
+    testPortfolioQueue();
+    testRobust();
+    testConstraintIndex();
+    return mapf_test::testResult();
+}
@@ -0,0 +1,97 @@
+#include "test_util.h"
+#include "mapf/mapf.h"
+
+#include <thread>
+#include <fstream>
+#include <cstdio>
+
+using namespace mapf;
+using mapf_test::makeGrid;
+
+// 空地上 4 连通的走廊内距离就是曼哈顿距离；8 连通时抽象路径按 4 连通选簇，
+// 走廊不一定覆盖最直的斜线，只要求不小于八方向距离、明显短于全直行
+static void testOpenMap() {
+    Grid grid = makeGrid(std::vector<std::string>(40, std::string(40, '.')));
+    MapHierarchy h(grid, 8);
+    CHECK(h.nodes() > 0);
+
+    Pos s{1, 2}, g{37, 30};
+    Corridor c = h.corridor(s, g);
+    CHECK(!c.empty());
+    CHECK_EQ(c.dist(s.x, s.y), manhattan(s, g));
+    CHECK_EQ(c.dist(g.x, g.y), 0);
+    CHECK(c.clusters() < 25u);    // 远小于全图 25 个簇就说明确实只取了走廊
+
+    Corridor c8 = h.corridor(s, g, MotionModel::EightConnected);
+    CHECK(c8.dist(s.x, s.y) >= EightConnected::heuristic(s, g));
+    CHECK(c8.dist(s.x, s.y) < 10 * manhattan(s, g));
+}
+
+// 墙把地图切成两半时走廊为空，CBS 直接判无解
+static void testDisconnected() {
+    std::vector<std::string> rows(20, std::string(20, '.'));
+    for (auto& r : rows) r[10] = '#';
+    Grid grid = makeGrid(rows);
+    MapHierarchy h(grid, 4);
+    CHECK(h.corridor(Pos{2, 2}, Pos{17, 5}).empty());
+    CHECK(!h.corridor(Pos{2, 2}, Pos{7, 18}).empty());
+
+    CBSOptions o;
+    o.hierarchy = &h;
+    std::vector<Path> sol;
+    CHECK(!CBS(grid, {Pos{2, 2}}, {Pos{17, 5}}, sol, o));
+}
+
+// 走廊模式下 CBS 的解仍然合法
+static void testSolve() {
+    std::vector<std::string> rows(32, std::string(32, '.'));
+    for (int y = 4; y < 28; y += 6)
+        for (int x = 2; x < 30; x++)
+            if (x % 7 != 0) rows[y][x] = '#';
+    Grid grid = makeGrid(rows);
+    MapHierarchy h(grid, 8);
+
+    std::vector<Pos> starts = {{0, 0}, {31, 31}, {0, 31}, {31, 0}, {15, 1}};
+    std::vector<Pos> goals  = {{31, 31}, {0, 0}, {31, 0}, {0, 31}, {15, 30}};
+    CBSOptions o;
+    o.hierarchy = &h;
+    std::vector<Path> sol;
+    CHECK(CBS(grid, starts, goals, sol, o));
+    ValidationOptions vo;
+    vo.starts = &starts;
+    vo.goals = &goals;
+    CHECK(validatePlan(grid, sol, vo).valid);
+}
+
+// 并发请求同一张地图的分层地图只建一份；读不到的地图每次都报错（失败不缓存）
+static void testMapCache() {
+    std::string path = "test_hierarchy_cache.map";
+    {
+        std::ofstream f(path);
+        for (int y = 0; y < 64; y++) f << std::string(64, '.') << "\n";
+    }
+    MapCache maps;
+    std::vector<std::shared_ptr<const MapHierarchy>> got(8);
+    std::vector<std::thread> ths;
+    for (int i = 0; i < 8; i++) ths.emplace_back([&, i]() { got[i] = maps.hierarchy(path, 8); });
+    for (auto& th : ths) th.join();
+    CHECK(got[0] != nullptr);
+    for (const auto& h : got) CHECK(h == got[0]);
+    CHECK(maps.hierarchy(path, 16) != got[0]);
+    CHECK(maps.get(path) == maps.get(path));
+    std::remove(path.c_str());
+
+    for (int k = 0; k < 2; k++) {
+        std::string err;
+        CHECK(maps.hierarchy("no_such_file.map", 8, &err) == nullptr);
+        CHECK(!err.empty());
+    }
+}
+
+int main() {
+    testOpenMap();
+    testDisconnected();
+    testSolve();
+    testMapCache();
+    return mapf_test::testResult();
+}
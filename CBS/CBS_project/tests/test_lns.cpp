@@ -0,0 +1,119 @@
+#include "test_util.h"
+#include "mapf/mapf.h"
+
+using namespace mapf;
+using mapf_test::makeGrid;
+
+static bool valid(const Grid& grid, const std::vector<Pos>& starts, const std::vector<Pos>& goals,
+                  const std::vector<Path>& paths) {
+    ValidationOptions vo;
+    vo.starts = &starts;
+    vo.goals = &goals;
+    return paths.size() == starts.size() && validatePlan(grid, paths, vo).valid;
+}
+
+// 8x8 空地中间两块障碍，8 个 agent 对穿：拥挤，优先级规划的初始解有绕路
+static void congested(Grid& grid, std::vector<Pos>& starts, std::vector<Pos>& goals) {
+    grid = makeGrid(std::vector<std::string>(8, std::string(8, '.')));
+    grid.g[3][3] = grid.g[4][4] = '#';
+    starts = {{0, 3}, {7, 3}, {3, 0}, {3, 7}, {0, 0}, {7, 7}, {0, 7}, {7, 0}};
+    goals  = {{7, 3}, {0, 3}, {3, 7}, {3, 0}, {7, 7}, {0, 0}, {7, 0}, {0, 7}};
+}
+
+struct Run {
+    bool ok = false;
+    std::vector<Path> paths;
+    std::vector<int> published;     // 每次回调的代价
+    LNSStats st;
+};
+
+static Run runLNS(const Grid& grid, const std::vector<Pos>& starts, const std::vector<Pos>& goals,
+                  std::vector<Path> init, const LNSOptions& o) {
+    Run r;
+    r.paths = std::move(init);
+    r.ok = LNS(grid, starts, goals, r.paths, o,
+               [&](const std::vector<Path>& paths, int cost) {
+                   CHECK_EQ(sumOfCosts(paths), cost);
+                   r.published.push_back(cost);
+               },
+               &r.st);
+    return r;
+}
+
+// 每个 agent 在起点先等几步的可行解（各走各的行，互不冲突）：LNS 应该把等待去掉
+static void testImproveDelayed() {
+    Grid grid = makeGrid(std::vector<std::string>(6, std::string(6, '.')));
+    std::vector<Pos> starts, goals;
+    std::vector<Path> init;
+    for (int y = 0; y < 6; y++) {
+        starts.push_back({0, y});
+        goals.push_back({5, y});
+        Path p(y + 2, Pos{0, y});
+        for (int x = 1; x <= 5; x++) p.push_back({x, y});
+        init.push_back(p);
+    }
+    LNSOptions o;
+    o.timeLimitMs = 60000;
+    o.maxIterations = 200;
+    o.neighborhoodSize = 2;
+    o.numThreads = 2;
+    o.seed = 3;
+    Run r = runLNS(grid, starts, goals, init, o);
+    CHECK(r.ok);
+    CHECK_EQ(r.st.initialCost, sumOfCosts(init));
+    CHECK(r.st.improvements > 0);
+    CHECK_EQ((int)r.published.size(), r.st.improvements);
+    CHECK_EQ(r.st.finalCost, 30);
+    CHECK(valid(grid, starts, goals, r.paths));
+}
+
+// 从优先级规划构造的初始解开始：回调的代价严格下降，结果合法，固定 seed 和线程数时可复现
+static void testCongested() {
+    Grid grid;
+    std::vector<Pos> starts, goals;
+    congested(grid, starts, goals);
+    LNSOptions o;
+    o.timeLimitMs = 60000;     // 只受迭代数限制，结果与机器快慢无关
+    o.maxIterations = 120;
+    o.neighborhoodSize = 3;
+    o.numThreads = 3;
+    o.seed = 7;
+    Run a = runLNS(grid, starts, goals, {}, o);
+    CHECK(a.ok);
+    CHECK(!a.published.empty());
+    CHECK_EQ(a.published.front(), a.st.initialCost);
+    CHECK(a.st.improvements > 0);
+    for (size_t i = 1; i < a.published.size(); i++) CHECK(a.published[i] < a.published[i - 1]);
+    CHECK(a.st.finalCost <= a.st.initialCost);
+    CHECK_EQ(a.st.finalCost, sumOfCosts(a.paths));
+    CHECK_EQ(a.st.iterations, o.maxIterations);
+    CHECK(valid(grid, starts, goals, a.paths));
+
+    // 不低于最优
+    std::vector<Path> opt;
+    CHECK(CBS(grid, starts, goals, opt));
+    CHECK(a.st.finalCost >= sumOfCosts(opt));
+
+    Run b = runLNS(grid, starts, goals, {}, o);
+    CHECK(b.published == a.published);
+    CHECK(b.paths == a.paths);
+    CHECK_EQ(b.st.improvements, a.st.improvements);
+}
+
+// 时间窗口很小时按时返回，返回的仍是可行解
+static void testDeadline() {
+    Grid grid;
+    std::vector<Pos> starts, goals;
+    congested(grid, starts, goals);
+    LNSOptions o;
+    o.timeLimitMs = 20;
+    std::vector<Path> sol;
+    if (LNS(grid, starts, goals, sol, o)) CHECK(valid(grid, starts, goals, sol));
+}
+
+int main() {
+    testImproveDelayed();
+    testCongested();
+    testDeadline();
+    return mapf_test::testResult();
+}
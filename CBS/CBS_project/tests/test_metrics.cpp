@@ -0,0 +1,188 @@
+#include "test_util.h"
+#include "mapf/mapf.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+using namespace mapf;
+using mapf_test::makeGrid;
+
+static Grid demoGrid() {
+    return makeGrid({
+        "..........",
+        ".####.....",
+        "..........",
+        ".....####.",
+        ".........."
+    });
+}
+
+// 指标行 "name value" 的值，找不到返回 -1
+static double valueOf(const std::string& text, const std::string& name) {
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line))
+        if (line.compare(0, name.size() + 1, name + " ") == 0) return std::stod(line.substr(name.size() + 1));
+    return -1;
+}
+
+// 直方图的桶是累积的，+Inf 桶等于 _count
+static bool cumulative(const std::string& text, const std::string& hist) {
+    std::istringstream in(text);
+    std::string line;
+    double last = 0;
+    while (std::getline(in, line)) {
+        if (line.compare(0, hist.size() + 8, hist + "_bucket{") != 0) continue;
+        double v = std::stod(line.substr(line.rfind(' ') + 1));
+        if (v < last) return false;
+        last = v;
+    }
+    return last == valueOf(text, hist + "_count");
+}
+
+static void testRecord() {
+    Grid grid = demoGrid();
+    std::vector<Pos> starts = {{0, 0}, {0, 4}}, goals = {{9, 4}, {2, 4}};
+    Metrics m;
+    CBSOptions o;
+    o.metrics = &m;
+    o.lowLevelCacheCapacity = 64;
+
+    // 两个线程各解两次，写在各自的分片里
+    std::vector<std::thread> ths;
+    for (int k = 0; k < 2; k++)
+        ths.emplace_back([&]() {
+            for (int r = 0; r < 2; r++) {
+                std::vector<Path> sol;
+                CHECK(CBS(grid, starts, goals, sol, o));
+            }
+        });
+    for (auto& t : ths) t.join();
+
+    std::atomic<bool> cancel{true};
+    CBSOptions oc;
+    oc.metrics = &m;
+    oc.cancel = &cancel;
+    std::vector<Path> sol;
+    CHECK(!CBS(grid, starts, goals, sol, oc));
+
+    std::string text = m.prometheusText();
+    CHECK_EQ(valueOf(text, "mapf_solves_total{result=\"solved\"}"), 4.0);
+    CHECK_EQ(valueOf(text, "mapf_solves_total{result=\"cancelled\"}"), 1.0);
+    CHECK_EQ(valueOf(text, "mapf_solves_total{result=\"timeout\"}"), 0.0);
+    CHECK_EQ(valueOf(text, "mapf_solve_duration_seconds_count"), 5.0);
+    CHECK_EQ(valueOf(text, "mapf_solve_cache_hit_ratio_count"), 4.0);
+    CHECK(valueOf(text, "mapf_low_level_expansions_count") >= 8);
+    CHECK(valueOf(text, "mapf_solve_low_level_expansions_sum") > 0);
+    CHECK(valueOf(text, "mapf_cache_misses_total") >= 8);
+    for (const char* h : {"mapf_solve_duration_seconds", "mapf_solve_ct_nodes_expanded",
+                          "mapf_solve_low_level_expansions", "mapf_low_level_duration_seconds"})
+        CHECK(cumulative(text, h));
+    CHECK(text.find("# TYPE mapf_solve_duration_seconds histogram") != std::string::npos);
+
+    std::string path = "test_metrics.prom";
+    CHECK(m.dumpToFile(path));
+    std::ifstream f(path);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    CHECK(ss.str() == text);
+    std::remove(path.c_str());
+}
+
+// 先后退出的线程不留下分片：分片并入汇总后释放，总数不丢
+static void testShortLivedThreads() {
+    Metrics m;
+    m.recordLowLevel(10, 0.001);
+    for (int i = 0; i < 200; i++)
+        std::thread([&]() { m.recordLowLevel(10, 0.001); }).join();
+    CHECK_EQ((int)m.shardCount(), 1);
+    std::string text = m.prometheusText();
+    CHECK_EQ(valueOf(text, "mapf_low_level_expansions_count"), 201.0);
+    CHECK_EQ(valueOf(text, "mapf_low_level_expansions_sum"), 2010.0);
+    CHECK(cumulative(text, "mapf_low_level_expansions"));
+
+    // 同时写的线程各有一个分片，退出后只剩主线程的
+    std::atomic<int> arrived{0};
+    std::atomic<bool> leave{false};
+    std::vector<std::thread> ths;
+    for (int k = 0; k < 4; k++)
+        ths.emplace_back([&]() {
+            m.recordLowLevel(10, 0.001);
+            arrived++;
+            while (!leave) std::this_thread::yield();
+        });
+    while (arrived < 4) std::this_thread::yield();
+    CHECK_EQ((int)m.shardCount(), 5);
+    leave = true;
+    for (auto& th : ths) th.join();
+    CHECK_EQ((int)m.shardCount(), 1);
+    CHECK_EQ(valueOf(m.prometheusText(), "mapf_low_level_expansions_count"), 205.0);
+}
+
+#ifndef _WIN32
+static std::string fetch(const std::string& socketPath, const std::string& request) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    for (int attempt = 0; attempt < 50; attempt++) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) {
+            if (!request.empty()) ::send(fd, request.data(), request.size(), 0);
+            std::string out;
+            char buf[4096];
+            ssize_t k;
+            while ((k = ::recv(fd, buf, sizeof(buf), 0)) > 0) out.append(buf, (size_t)k);
+            ::close(fd);
+            return out;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));   // 服务线程还没 listen
+    }
+    return "";
+}
+
+static void testSocket() {
+    Metrics m;
+    Grid grid = demoGrid();
+    CBSOptions o;
+    o.metrics = &m;
+    std::vector<Path> sol;
+    CHECK(CBS(grid, {{0, 0}, {0, 4}}, {{9, 4}, {2, 4}}, sol, o));
+
+    std::string path = "test_metrics.sock";
+    std::atomic<bool> stop{false};
+    bool served = false;
+    std::thread th([&]() { served = serveMetrics(m, path, &stop); });
+
+    std::string plain = fetch(path, "");
+    CHECK(plain == m.prometheusText());
+    std::string http = fetch(path, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    CHECK(http.compare(0, 15, "HTTP/1.0 200 OK") == 0);
+    CHECK(http.find("\r\n\r\n" + m.prometheusText()) != std::string::npos);
+
+    stop = true;
+    th.join();
+    CHECK(served);
+}
+#endif
+
+int main() {
+    testRecord();
+    testShortLivedThreads();
+#ifndef _WIN32
+    testSocket();
+#endif
+    return mapf_test::testResult();
+}
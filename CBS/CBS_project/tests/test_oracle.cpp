@@ -0,0 +1,228 @@
+// expected.txt 里最优代价的独立核对，不用库里的低层搜索、冲突检测和 CBS：
+//   1. 自己的 BFS / Dijkstra 求每个 agent 的单体最短距离，代价和是下界；存的代价必须不低于它，
+//      等于它时就是最优（回归测试保证有合法解达到这个代价）
+//   2. 联合状态空间 A*（算子分解），在扩展数上限内解得出的实例直接比对精确最优值
+//   test_oracle DATA_DIR [--budget N]     N 是每个实例每种运动模型的扩展上限（默认 3000000）
+// 手工小实例（demo、pocket-swap、ring-4、cross-8）必须被 1 或 2 证明，否则算失败
+#include "test_util.h"
+#include "corpus.h"
+
+#include <queue>
+#include <unordered_set>
+#include <cstdlib>
+
+using namespace mapf;
+using namespace mapf_test;
+
+namespace {
+
+struct Costs {
+    bool diagonal;
+    int straight, diag, wait;
+};
+const Costs kFour{false, 1, 1, 1};
+const Costs kEight{true, 10, 14, 10};    // 与 EightConnected 相同：斜行不能切角
+
+const int kDx[9] = {1, -1, 0, 0, 1, 1, -1, -1, 0};
+const int kDy[9] = {0, 0, 1, -1, 1, -1, 1, -1, 0};
+
+bool passable(const Grid& g, int x, int y) {
+    return x >= 0 && y >= 0 && x < g.W && y < g.H && g.g[y][x] == '.';
+}
+
+// 从 (x, y) 走动作 k 是否合法；合法时返回这一步的代价
+int stepCost(const Grid& g, const Costs& c, int x, int y, int k) {
+    if (k == 8) return c.wait;
+    if (!c.diagonal && k >= 4) return -1;
+    int nx = x + kDx[k], ny = y + kDy[k];
+    if (!passable(g, nx, ny)) return -1;
+    if (k < 4) return c.straight;
+    return passable(g, nx, y) && passable(g, x, ny) ? c.diag : -1;
+}
+
+// 到 goal 的单体最短距离（动作可逆，从 goal 反向 Dijkstra 即可）
+std::vector<int> distances(const Grid& g, const Costs& c, Pos goal) {
+    const int INF = 1 << 29;
+    std::vector<int> d((size_t)g.W * g.H, INF);
+    using Item = std::pair<int, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> pq;
+    d[goal.y * g.W + goal.x] = 0;
+    pq.push({0, goal.y * g.W + goal.x});
+    while (!pq.empty()) {
+        auto [dist, cell] = pq.top();
+        pq.pop();
+        if (dist > d[cell]) continue;
+        int x = cell % g.W, y = cell / g.W;
+        for (int k = 0; k < 8; k++) {
+            int w = stepCost(g, c, x, y, k);
+            if (w < 0) continue;
+            int nc = (y + kDy[k]) * g.W + x + kDx[k];
+            if (dist + w < d[nc]) {
+                d[nc] = dist + w;
+                pq.push({d[nc], nc});
+            }
+        }
+    }
+    return d;
+}
+
+// 联合 A* + 算子分解：一层里按 agent 顺序逐个定下一时刻的位置。
+// 代价和的口径：停在终点的等待先记账（debt），之后离开终点时才计入，到达后一直不动就不计
+struct Node {
+    std::vector<int> pos;        // 前 next 个 agent 已经是下一时刻的位置
+    std::vector<int> prev;       // 本层开始时的位置（判交换和对角交叉）
+    std::vector<int> debt;
+    int next = 0;
+    int g = 0, f = 0;
+};
+
+std::string keyOf(const Node& s) {
+    std::string k;
+    auto put = [&](int v) { k.append(reinterpret_cast<const char*>(&v), sizeof(v)); };
+    put(s.next);
+    for (int v : s.pos) put(v);
+    for (int v : s.debt) put(v);
+    // 层中间的状态还依赖已动 agent 的出发位置
+    for (int i = 0; i < s.next; i++) put(s.prev[i]);
+    return k;
+}
+
+// 返回精确最优代价和；超过扩展上限返回 -1，无解返回 -2
+long long jointOptimum(const Grid& g, const Costs& c, const Instance& in, long long budget) {
+    const int n = (int)in.starts.size();
+    std::vector<std::vector<int>> h(n);
+    std::vector<int> goal(n);
+    Node root;
+    for (int i = 0; i < n; i++) {
+        h[i] = distances(g, c, in.goals[i]);
+        goal[i] = in.goals[i].y * g.W + in.goals[i].x;
+        int s = in.starts[i].y * g.W + in.starts[i].x;
+        if (h[i][s] >= (1 << 29)) return -2;
+        root.pos.push_back(s);
+        root.f += h[i][s];
+    }
+    root.prev = root.pos;
+    root.debt.assign(n, 0);
+
+    auto cmp = [](const Node& a, const Node& b) { return a.f != b.f ? a.f > b.f : a.g < b.g; };
+    std::priority_queue<Node, std::vector<Node>, decltype(cmp)> open(cmp);
+    std::unordered_set<std::string> closed;
+    open.push(root);
+    long long expanded = 0;
+    while (!open.empty()) {
+        Node s = open.top();
+        open.pop();
+        if (!closed.insert(keyOf(s)).second) continue;
+        if (s.next == 0) {
+            bool done = true;
+            for (int i = 0; i < n && done; i++) done = s.pos[i] == goal[i];
+            if (done) return s.g;
+        }
+        if (++expanded > budget) return -1;
+
+        int i = s.next;
+        int x = s.pos[i] % g.W, y = s.pos[i] / g.W;
+        for (int k = 0; k < 9; k++) {
+            int w = stepCost(g, c, x, y, k);
+            if (w < 0) continue;
+            int to = (y + kDy[k]) * g.W + x + kDx[k];
+            bool ok = true;
+            for (int j = 0; j < i && ok; j++) {
+                if (s.pos[j] == to) ok = false;                                    // 顶点冲突
+                else if (s.pos[j] == s.pos[i] && s.prev[j] == to) ok = false;      // 交换
+                else if (c.diagonal && k >= 4 && k < 8) {                          // 2x2 方格里对角线交叉
+                    int jx0 = s.prev[j] % g.W, jy0 = s.prev[j] / g.W;
+                    int jx1 = s.pos[j] % g.W, jy1 = s.pos[j] / g.W;
+                    int tx = x + kDx[k], ty = y + kDy[k];
+                    ok = !(jx0 == x && jy0 == ty && jx1 == tx && jy1 == y) &&
+                         !(jx0 == tx && jy0 == y && jx1 == x && jy1 == ty);
+                }
+            }
+            // 还没动的 agent 停在原地的情况由它们自己那一步检查
+            if (!ok) continue;
+            Node t = s;
+            t.prev[i] = s.pos[i];
+            t.pos[i] = to;
+            if (k == 8 && s.pos[i] == goal[i]) {
+                t.debt[i] += w;
+            } else {
+                t.g += w + s.debt[i];
+                t.debt[i] = 0;
+            }
+            t.f = t.g;
+            for (int a = 0; a < n; a++) t.f += h[a][t.pos[a]];
+            t.next = (i + 1) % n;
+            if (t.next == 0) t.prev = t.pos;
+            open.push(std::move(t));
+        }
+    }
+    return -2;
+}
+
+// 联合搜索只对 agent 不多的实例有希望在上限内解完
+const size_t kMaxJointAgents = 6;
+
+bool handMade(const std::string& id) {
+    return id == "demo" || id == "pocket-swap" || id == "ring-4" || id == "cross-8";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: test_oracle DATA_DIR [--budget N]\n";
+        return 2;
+    }
+    std::string dataDir = argv[1];
+    long long budget = 3000000;
+    if (argc > 3 && std::string(argv[2]) == "--budget") budget = std::atoll(argv[3]);
+
+    MapCache maps;
+    std::vector<CorpusEntry> corpus;
+    std::string err;
+    if (!loadCorpus(dataDir, corpus, maps, &err)) { std::cerr << err << "\n"; return 1; }
+    auto exp = loadExpected(dataDir + "/expected.txt");
+
+    int byJoint = 0, byBound = 0, boundOnly = 0;
+    for (const auto& e : corpus) {
+        const std::string& id = e.inst.id;
+        auto it = exp.find(id);
+        if (it == exp.end()) { std::cerr << id << ": no expected cost\n"; failures()++; continue; }
+
+        for (int m = 0; m < 2; m++) {
+            const Costs& c = m == 0 ? kFour : kEight;
+            int stored = m == 0 ? it->second.soc : it->second.soc8;
+            const char* model = m == 0 ? "soc" : "soc8";
+
+            long long lb = 0;
+            for (size_t i = 0; i < e.inst.starts.size(); i++) {
+                Pos s = e.inst.starts[i];
+                lb += distances(*e.grid, c, e.inst.goals[i])[s.y * e.grid->W + s.x];
+            }
+            if (stored < lb) {
+                std::cerr << id << " " << model << ": stored " << stored << " below lower bound " << lb << "\n";
+                failures()++;
+                continue;
+            }
+            long long opt = e.inst.starts.size() <= kMaxJointAgents ? jointOptimum(*e.grid, c, e.inst, budget) : -1;
+            if (opt >= 0) {
+                byJoint++;
+                if (opt != stored) {
+                    std::cerr << id << " " << model << ": stored " << stored << ", joint search " << opt << "\n";
+                    failures()++;
+                }
+            } else if (stored == lb) {
+                byBound++;
+            } else {
+                boundOnly++;
+                if (handMade(id)) {
+                    std::cerr << id << " " << model << ": not verified within budget\n";
+                    failures()++;
+                }
+            }
+        }
+    }
+    std::cout << "[oracle] joint-search=" << byJoint << " lower-bound-tight=" << byBound
+              << " bound-only=" << boundOnly << "\n";
+    return testResult();
+}
@@ -0,0 +1,78 @@
+// 性能回归：只比较与硬件无关的计数（CT 扩展数、低层扩展数）。任一实例的计数超过
+// expected.txt 基线 (1 + tolerance) 倍（再加一点绝对余量，避免小实例抖动）就失败。
+// 计数整体明显下降时提示用 test_regression --update 更新基线。
+//   test_perf DATA_DIR [TOLERANCE]   默认 0.10
+#include "test_util.h"
+#include "corpus.h"
+
+#include <cstdlib>
+
+using namespace mapf;
+using namespace mapf_test;
+
+namespace {
+
+bool exceeds(long long actual, long long base, double tol, long long slack) {
+    return actual > (long long)(base * (1.0 + tol)) + slack;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: test_perf DATA_DIR [TOLERANCE]\n";
+        return 2;
+    }
+    std::string dataDir = argv[1];
+    double tol = argc > 2 ? std::atof(argv[2]) : 0.10;
+
+    MapCache maps;
+    std::vector<CorpusEntry> corpus;
+    std::string err;
+    if (!loadCorpus(dataDir, corpus, maps, &err)) { std::cerr << err << "\n"; return 1; }
+    auto exp = loadExpected(dataDir + "/expected.txt");
+
+    long long base[4] = {0, 0, 0, 0}, now[4] = {0, 0, 0, 0};
+    for (const auto& e : corpus) {
+        auto it = exp.find(e.inst.id);
+        if (it == exp.end()) {
+            std::cerr << e.inst.id << ": no baseline (run test_regression --update)\n";
+            failures()++;
+            continue;
+        }
+        const Expected& x = it->second;
+
+        CBSOptions modes[2] = {CBSOptions{}, fastOptions()};
+        const long long expect[2][2] = {{x.ct, x.llexp}, {x.ctFast, x.llexpFast}};
+        for (int k = 0; k < 2; k++) {
+            modes[k].ctNodeLimit = 50000;
+            std::vector<Path> sol;
+            CBSStats st;
+            if (!CBS(*e.grid, e.inst.starts, e.inst.goals, sol, modes[k], &st)) {
+                std::cerr << e.inst.id << (k ? " fast" : " default") << ": not solved\n";
+                failures()++;
+                continue;
+            }
+            if (exceeds(st.ctExpanded, expect[k][0], tol, 2) ||
+                exceeds(st.lowLevelExpansions, expect[k][1], tol, 50)) {
+                std::cerr << e.inst.id << (k ? " fast" : " default") << ": ct " << st.ctExpanded
+                          << " (baseline " << expect[k][0] << "), llexp " << st.lowLevelExpansions
+                          << " (baseline " << expect[k][1] << ")\n";
+                failures()++;
+            }
+            base[2 * k] += expect[k][0];
+            base[2 * k + 1] += expect[k][1];
+            now[2 * k] += st.ctExpanded;
+            now[2 * k + 1] += st.lowLevelExpansions;
+        }
+    }
+
+    const char* names[4] = {"ct", "llexp", "ct-fast", "llexp-fast"};
+    for (int i = 0; i < 4; i++) {
+        std::cout << names[i] << ": " << now[i] << " (baseline " << base[i] << ")\n";
+        if (base[i] > 0 && now[i] < base[i] * (1.0 - tol))
+            std::cout << "  " << names[i] << " dropped by more than " << tol * 100
+                      << "%, consider test_regression --update\n";
+    }
+    return testResult();
+}
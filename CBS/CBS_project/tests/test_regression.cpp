@@ -0,0 +1,211 @@
+// 最优性回归：语料里每个实例在每种求解模式下求解，最优模式的代价必须等于 expected.txt 里存的最优代价，
+// 有界次优模式不超过 w 倍，其余模式至少不低于最优；所有解都要过 validatePlan。
+//   test_regression DATA_DIR [MODE]     只跑一种模式（ctest 每种模式一个用例）
+//   test_regression DATA_DIR --update   重新生成 expected.txt（代价和计数基线）
+#include "test_util.h"
+#include "corpus.h"
+
+#include <fstream>
+#include <unordered_map>
+
+using namespace mapf;
+using namespace mapf_test;
+
+namespace {
+
+enum class Check {
+    Optimal,    // 代价 == 最优
+    Bounded,    // 最优 <= 代价 <= w * 最优
+    Valid       // 只要求合法，代价 >= 最优
+};
+
+struct Mode {
+    std::string name;
+    CBSOptions cbs;
+    Check check = Check::Optimal;
+    bool portfolio = false;
+    bool warm = false;          // 用默认模式的解做热启动
+    int hierarchy = 0;          // > 0 时按这个簇大小建分层地图
+    int maxAgents = 0;          // > 0 时只跑 agent 数不超过它的实例（冷节点重建很贵的组合）
+};
+
+std::vector<Mode> allModes() {
+    std::vector<Mode> modes;
+    auto add = [&](const std::string& name, CBSOptions o, Check c = Check::Optimal) {
+        Mode m;
+        m.name = name;
+        m.cbs = o;
+        m.check = c;
+        modes.push_back(m);
+        return &modes.back();
+    };
+
+    CBSOptions o;
+    add("default", o);
+    o = CBSOptions{}; o.disjointSplitting = true;                   add("disjoint", o);
+    o = CBSOptions{}; o.symmetryReasoning = true;                   add("symmetry", o);
+    o = CBSOptions{}; o.incrementalLowLevel = true;                 add("incremental", o);
+    o = CBSOptions{}; o.lowLevelCacheCapacity = 1024;               add("cache", o);
+    o = CBSOptions{}; o.pruneDuplicateNodes = true;                 add("prune-dups", o);
+    o = CBSOptions{}; o.conflictSelection = ConflictSelection::MostInvolved; add("conflict-most", o);
+    o = CBSOptions{}; o.conflictSelection = ConflictSelection::Random; o.seed = 11; add("conflict-random", o);
+    o = CBSOptions{}; o.memoryBudgetBytes = 64 << 10;               add("memory-budget", o);
+    add("fast", fastOptions());
+    o = CBSOptions{}; o.suboptimality = 1.2;                        add("subopt-1.2", o, Check::Bounded);
+    add("portfolio", CBSOptions{})->portfolio = true;
+    add("warm-start", CBSOptions{})->warm = true;
+    add("hierarchy", CBSOptions{}, Check::Valid)->hierarchy = 8;
+    // k-robust 的最优代价不在 expected.txt 里，只要求不低于普通最优且没有 k 步内的冲突
+    o = CBSOptions{}; o.robustness = 1; o.symmetryReasoning = true;
+    add("robust-1", o, Check::Valid)->maxAgents = 5;
+
+    // 8 连通：代价和 soc8 比较；增量搜索和对称推理只支持 4 连通，不列
+    o = CBSOptions{}; o.motion = MotionModel::EightConnected;       add("eight", o);
+    o.disjointSplitting = true;                                     add("eight-disjoint", o);
+    o = CBSOptions{}; o.motion = MotionModel::EightConnected;
+    o.lowLevelCacheCapacity = 1024; o.pruneDuplicateNodes = true;   add("eight-cache", o);
+    o = CBSOptions{}; o.motion = MotionModel::EightConnected; o.memoryBudgetBytes = 64 << 10;
+    add("eight-memory-budget", o)->maxAgents = 10;
+
+    // 按 CT 节点数而不是墙钟时间限制，机器繁忙时结论不变（最难的实例约 1.6 万个节点）
+    for (auto& m : modes) m.cbs.ctNodeLimit = 50000;
+    return modes;
+}
+
+int costOf(const std::vector<Path>& paths, MotionModel motion) {
+    return sumOfCosts(paths, motion);
+}
+
+bool solve(const Mode& m, const CorpusEntry& e, std::vector<Path>& sol, const MapHierarchy* hier) {
+    const Instance& in = e.inst;
+    if (m.portfolio) {
+        PortfolioOptions po;
+        po.variants = defaultPortfolio(1.0);
+        for (auto& v : po.variants) v.cbs.ctNodeLimit = m.cbs.ctNodeLimit;
+        po.maxThreads = 2;
+        return portfolioCBS(*e.grid, in.starts, in.goals, sol, po);
+    }
+    CBSOptions o = m.cbs;
+    o.hierarchy = hier;
+    std::vector<Path> seed;
+    if (m.warm) {
+        if (!CBS(*e.grid, in.starts, in.goals, seed, o)) return false;
+        o.initialPaths = &seed;
+    }
+    return CBS(*e.grid, in.starts, in.goals, sol, o);
+}
+
+void runMode(const Mode& m, const std::vector<CorpusEntry>& corpus, const std::map<std::string, Expected>& exp) {
+    std::unordered_map<const Grid*, std::unique_ptr<MapHierarchy>> hiers;
+    for (const auto& e : corpus) {
+        const std::string& id = e.inst.id;
+        if (m.maxAgents > 0 && (int)e.inst.starts.size() > m.maxAgents) continue;
+        auto it = exp.find(id);
+        if (it == exp.end()) {
+            std::cerr << m.name << " " << id << ": no expected cost (run --update)\n";
+            failures()++;
+            continue;
+        }
+        const MapHierarchy* hier = nullptr;
+        if (m.hierarchy > 0) {
+            auto& h = hiers[e.grid.get()];
+            if (!h) h.reset(new MapHierarchy(*e.grid, m.hierarchy));
+            hier = h.get();
+        }
+
+        std::vector<Path> sol;
+        if (!solve(m, e, sol, hier)) {
+            std::cerr << m.name << " " << id << ": not solved\n";
+            failures()++;
+            continue;
+        }
+        ValidationOptions vo;
+        vo.motion = m.cbs.motion;
+        vo.starts = &e.inst.starts;
+        vo.goals = &e.inst.goals;
+        ValidationReport rep = validatePlan(*e.grid, sol, vo);
+        if (sol.size() != e.inst.starts.size() || !rep.valid) {
+            std::cerr << m.name << " " << id << ": invalid solution (" << rep.total() << " violations)\n";
+            failures()++;
+            continue;
+        }
+        if (m.cbs.robustness > 0 && detectFirstConflict<FourConnected>(sol, m.cbs.robustness).exists) {
+            std::cerr << m.name << " " << id << ": not " << m.cbs.robustness << "-robust\n";
+            failures()++;
+            continue;
+        }
+
+        int opt = m.cbs.motion == MotionModel::EightConnected ? it->second.soc8 : it->second.soc;
+        int cost = costOf(sol, m.cbs.motion);
+        bool ok = m.check == Check::Optimal ? cost == opt
+                : m.check == Check::Bounded ? opt <= cost && cost <= m.cbs.suboptimality * opt + 1e-9
+                                            : cost >= opt;
+        if (!ok) {
+            std::cerr << m.name << " " << id << ": cost " << cost << ", optimal " << opt << "\n";
+            failures()++;
+        }
+    }
+}
+
+// 最优代价取默认模式的解，计数基线取默认模式和 fast 模式
+int update(const std::string& dataDir, const std::vector<CorpusEntry>& corpus) {
+    std::ofstream out(dataDir + "/expected.txt");
+    if (!out) { std::cerr << "cannot write expected.txt\n"; return 1; }
+    out << "# 由 test_regression DATA_DIR --update 生成；soc/soc8 由 test_oracle 独立核对：\n"
+           "# agent 不超过 6 个的实例用联合 A*（算子分解）穷举求精确最优，其余检查不低于单体最短距离之和\n"
+           "# id soc soc8 ct llexp ctFast llexpFast\n";
+    for (const auto& e : corpus) {
+        const Instance& in = e.inst;
+        CBSOptions o;
+        o.ctNodeLimit = 50000;
+        CBSOptions o8 = o;
+        o8.motion = MotionModel::EightConnected;
+        CBSOptions of = fastOptions();
+        of.ctNodeLimit = o.ctNodeLimit;
+
+        std::vector<Path> s4, s8, sf;
+        CBSStats st4, stf;
+        if (!CBS(*e.grid, in.starts, in.goals, s4, o, &st4) || !CBS(*e.grid, in.starts, in.goals, s8, o8) ||
+            !CBS(*e.grid, in.starts, in.goals, sf, of, &stf)) {
+            std::cerr << in.id << ": not solved, drop it from the corpus\n";
+            return 1;
+        }
+        out << in.id << ' ' << sumOfCosts(s4) << ' ' << sumOfCosts<EightConnected>(s8) << ' '
+            << st4.ctExpanded << ' ' << st4.lowLevelExpansions << ' '
+            << stf.ctExpanded << ' ' << stf.lowLevelExpansions << '\n';
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: test_regression DATA_DIR [MODE|--update|--list]\n";
+        return 2;
+    }
+    std::string dataDir = argv[1];
+    std::string arg = argc > 2 ? argv[2] : "";
+
+    std::vector<Mode> modes = allModes();
+    if (arg == "--list") {
+        for (const auto& m : modes) std::cout << m.name << "\n";
+        return 0;
+    }
+
+    MapCache maps;
+    std::vector<CorpusEntry> corpus;
+    std::string err;
+    if (!loadCorpus(dataDir, corpus, maps, &err)) { std::cerr << err << "\n"; return 1; }
+    if (arg == "--update") return update(dataDir, corpus);
+
+    auto exp = loadExpected(dataDir + "/expected.txt");
+    bool any = false;
+    for (const auto& m : modes) {
+        if (!arg.empty() && m.name != arg) continue;
+        any = true;
+        runMode(m, corpus, exp);
+    }
+    if (!any) { std::cerr << "unknown mode " << arg << "\n"; return 2; }
+    return testResult();
+}
@@ -0,0 +1,87 @@
+#include "test_util.h"
+#include "mapf/mapf.h"
+
+#include <thread>
+#include <memory>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace mapf;
+
+static TraceEvent event(int node) {
+    TraceEvent ev;
+    ev.node = node;
+    return ev;
+}
+
+// 先后退出的线程复用同一个缓冲：缓冲数只等于同时写的线程数，之前的事件还在
+static void testRingReuse() {
+    Tracer tr(64);
+    for (int i = 0; i < 100; i++)
+        std::thread([&]() { tr.record(event(i)); }).join();
+    std::vector<TraceEvent> evs = tr.snapshot();
+    CHECK_EQ((int)evs.size(), 64);
+    CHECK_EQ(tr.dropped(), (uint64_t)36);
+    for (const auto& ev : evs) CHECK_EQ((int)ev.tid, 0);
+
+    // 两个线程同时写时各有一个缓冲
+    std::atomic<int> arrived{0};
+    std::vector<std::thread> ths;
+    for (int k = 0; k < 2; k++)
+        ths.emplace_back([&, k]() {
+            tr.record(event(1000 + k));
+            arrived++;
+            while (arrived < 2) std::this_thread::yield();   // 两个线程都拿到缓冲后才退出
+        });
+    for (auto& th : ths) th.join();
+    std::set<int> tids;
+    for (const auto& ev : tr.snapshot()) tids.insert(ev.tid);
+    CHECK_EQ((int)tids.size(), 2);
+}
+
+// 长期运行的线程见过很多 Tracer：仍存活的 Tracer 一直用同一个缓冲
+static void testLongLivedThread() {
+    Tracer keep(16);
+    keep.record(event(0));
+    for (int i = 0; i < 40; i++) {
+        std::unique_ptr<Tracer> tmp(new Tracer(16));
+        tmp->record(event(i));
+        keep.record(event(i));
+    }
+    std::vector<TraceEvent> evs = keep.snapshot();
+    CHECK_EQ((int)evs.size(), 16);
+    for (const auto& ev : evs) CHECK_EQ((int)ev.tid, 0);
+}
+
+// Tracer 先于写线程析构：线程退出时不会再碰它
+static void testTracerGoneFirst() {
+    std::unique_ptr<Tracer> tr(new Tracer(16));
+    bool go = false, recorded = false;
+    std::mutex mu;
+    std::condition_variable cv;
+    std::thread th([&]() {
+        tr->record(event(1));
+        std::unique_lock<std::mutex> lock(mu);
+        recorded = true;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return go; });
+    });
+    {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&]() { return recorded; });
+        tr.reset();
+        go = true;
+    }
+    cv.notify_all();
+    th.join();
+    CHECK(!tr);
+}
+
+int main() {
+    testRingReuse();
+    testLongLivedThread();
+    testTracerGoneFirst();
+    return mapf_test::testResult();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include "mapf/grid.h"
+
+// 极简断言：失败时打印位置并计数，不中断后续检查；main 最后返回 testResult()
+namespace mapf_test {
+
+inline int& failures() {
+    static int n = 0;
+    return n;
+}
+
+inline int testResult() {
+    if (failures()) std::cerr << failures() << " check(s) failed\n";
+    return failures() ? 1 : 0;
+}
+
+// 用 '.'/'#' 字符串行构造地图
+inline mapf::Grid makeGrid(const std::vector<std::string>& rows) {
+    mapf::Grid g;
+    g.g = rows;
+    g.H = (int)rows.size();
+    g.W = rows.empty() ? 0 : (int)rows[0].size();
+    return g;
+}
+
+} // namespace mapf_test
+
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n";  \
+            mapf_test::failures()++;                                                    \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                  \
+    do {                                                                                \
+        auto va_ = (a);                                                                 \
+        auto vb_ = (b);                                                                 \
+        if (!(va_ == vb_)) {                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b ") failed: " \
+                      << va_ << " vs " << vb_ << "\n";                                  \
+            mapf_test::failures()++;                                                    \
+        }                                                                               \
+    } while (0)
@@ -0,0 +1,77 @@
+#include "test_util.h"
+#include "mapf/mapf.h"
+
+using namespace mapf;
+using mapf_test::makeGrid;
+
+static void testCounts() {
+    Grid grid = makeGrid({
+        ".....",
+        "..#..",
+        "....."
+    });
+    std::vector<Path> paths = {
+        {{0, 0}, {1, 0}, {2, 0}},     // t=1 与 agent 1 同格
+        {{2, 0}, {1, 0}, {0, 0}},
+        {{0, 2}, {1, 2}, {2, 2}},
+        {{1, 2}, {0, 2}},             // 与 agent 2 在 t=0->1 对穿
+        {{3, 1}, {2, 1}},             // 走进障碍，路径结束后停在那里，t=2 再计一次
+        {{4, 0}, {4, 2}},             // 一步走两格
+    };
+    ValidationReport rep = validatePlan(grid, paths);
+    CHECK(!rep.valid);
+    CHECK_EQ(rep.vertex, 1LL);
+    CHECK_EQ(rep.swap, 1LL);
+    CHECK_EQ(rep.obstacle, 2LL);
+    CHECK_EQ(rep.jump, 1LL);
+    CHECK_EQ(rep.perAgent[0], 1);
+    CHECK_EQ(rep.perAgent[3], 1);
+    CHECK_EQ(rep.perTimestep[0], 2);    // 对穿和跳格记在这一步的起始时刻
+    CHECK_EQ(rep.perTimestep[1], 2);    // 同格 + 障碍
+    CHECK_EQ(rep.perTimestep[2], 1);
+
+    std::vector<Pos> goals = {{2, 0}, {0, 0}, {2, 2}, {0, 2}, {2, 1}, {3, 2}};
+    ValidationOptions vo;
+    vo.goals = &goals;
+    CHECK_EQ(validatePlan(grid, paths, vo).endpoint, 1LL);
+}
+
+static void testThreadsAgree() {
+    Grid grid = makeGrid(std::vector<std::string>(16, std::string(16, '.')));
+    std::vector<Path> paths(40);
+    for (int i = 0; i < 40; i++) {
+        Pos p{i % 16, i / 16};
+        for (int t = 0; t < 300; t++) {
+            paths[i].push_back(p);
+            int k = (i * 7 + t * 13) % 5;
+            if (k == 0 && p.x < 15) p.x++;
+            if (k == 1 && p.x > 0) p.x--;
+            if (k == 2 && p.y < 15) p.y++;
+            if (k == 3 && p.y > 0) p.y--;
+        }
+    }
+    ValidationOptions one, many;
+    one.threads = 1;
+    many.threads = 4;
+    ValidationReport a = validatePlan(grid, paths, one), b = validatePlan(grid, paths, many);
+    CHECK(a.vertex > 0);
+    CHECK_EQ(a.vertex, b.vertex);
+    CHECK_EQ(a.swap, b.swap);
+    CHECK(a.perTimestep == b.perTimestep);
+    CHECK(a.perAgent == b.perAgent);
+}
+
+static void testPathCodec() {
+    Path p = {{2, 3}, {3, 3}, {3, 4}, {3, 4}, {2, 4}, {2, 3}};
+    Path q;
+    CHECK(decodePath(encodePath(p), q));
+    CHECK(q == p);
+    CHECK(!decodePath("1,1:RX", q));
+}
+
+int main() {
+    testCounts();
+    testThreadsAgree();
+    testPathCodec();
+    return mapf_test::testResult();
+}